@@ -713,10 +713,25 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
      [used by Jeff Rowberg for I2Cdevlib with permission]
      */
 
+    // state of the interrupt driven read, see readBufAsync()
+    static byte asyncDevice, asyncAddress, asyncNum;
+    static byte *asyncData;
+    static volatile byte asyncIndex;
+    static volatile byte asyncStatus = TW_OK;
+    static unsigned long asyncStart, asyncTimeout;
+    static unsigned int byteMicros = 45; // twice the time of one byte (9 clocks)
+
     boolean Fastwire::waitInt() {
         int l = 250;
         while (!(TWCR & (1 << TWINT)) && l-- > 0);
-        return l > 0;
+        if (l > 0) return true;
+        recover(); // don't leave the bus hanging, the next transfer starts clean
+        return false;
+    }
+
+    void Fastwire::waitIdle() {
+        // bounded by the timeout of the running transfer
+        while (poll() == TW_BUSY);
     }
 
     void Fastwire::setup(int khz, boolean pullup) {
@@ -740,6 +755,7 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
         TWSR = 0; // no prescaler => prescaler = 1
         TWBR = ((16000L / khz) - 16) / 2; // change the I2C clock rate
         TWCR = 1 << TWEN; // enable twi module, no interrupt
+        byteMicros = 2 * 9000 / khz;
     }
 
     // added by Jeff Rowberg 2013-05-07:
@@ -747,6 +763,7 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
     // (takes 7-bit device address like the Wire method, NOT 8-bit: 0x68, not 0xD0/0xD1)
     byte Fastwire::beginTransmission(byte device) {
         byte twst, retry;
+        waitIdle();
         retry = 2;
         do {
             TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO) | (1 << TWSTA);
@@ -767,6 +784,7 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
 
     byte Fastwire::writeBuf(byte device, byte address, byte *data, byte num) {
         byte twst, retry;
+        waitIdle();
 
         retry = 2;
         do {
@@ -819,6 +837,7 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
 
     byte Fastwire::readBuf(byte device, byte address, byte *data, byte num) {
         byte twst, retry;
+        waitIdle();
 
         retry = 2;
         do {
@@ -886,8 +905,100 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
 
     byte Fastwire::stop() {
         TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
-        if (!waitInt()) return 1;
-        return 0;
+        // no TWINT after a STOP, TWSTO clears once it is on the bus
+        int l = 250;
+        while ((TWCR & (1 << TWSTO)) && l-- > 0);
+        return l > 0 ? 0 : 1;
+    }
+
+    byte Fastwire::readBufAsync(byte device, byte address, byte *data, byte num) {
+        waitIdle();
+        if (num == 0) return TW_OK;
+
+        asyncDevice = device;
+        asyncAddress = address;
+        asyncData = data;
+        asyncNum = num;
+        asyncIndex = 0;
+        asyncStatus = TW_BUSY;
+
+        // address, register, repeated start, data: a bounded wait instead of a stall
+        asyncStart = micros();
+        asyncTimeout = (unsigned long)(num + 4) * byteMicros;
+
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO) | (1 << TWSTA) | (1 << TWIE);
+        return TW_OK;
+    }
+
+    byte Fastwire::poll() {
+        if (asyncStatus == TW_BUSY && micros() - asyncStart > asyncTimeout) {
+            recover();
+            asyncStatus = TW_ERROR;
+        }
+        return asyncStatus;
+    }
+
+    void Fastwire::recover() {
+        TWCR = 0; // hand SDA and SCL back to the port, both are released
+        digitalWrite(SDA, LOW);
+        digitalWrite(SCL, LOW);
+        pinMode(SDA, INPUT);
+
+        // clock until a slave holding SDA low is done with its byte
+        for (byte i = 0; i < 9 && !digitalRead(SDA); i++) {
+            pinMode(SCL, OUTPUT);
+            delayMicroseconds(5);
+            pinMode(SCL, INPUT);
+            delayMicroseconds(5);
+        }
+
+        // STOP: SDA rises while SCL is high
+        pinMode(SDA, OUTPUT);
+        delayMicroseconds(5);
+        pinMode(SDA, INPUT);
+        delayMicroseconds(5);
+
+        TWCR = 1 << TWEN;
+    }
+
+    // the read started by readBufAsync(), one step per TWI interrupt
+    ISR(TWI_vect) {
+        byte twst = TWSR & 0xF8;
+        switch (twst) {
+            case TW_START:
+                TWDR = asyncDevice & 0xFE; // device address to write the register
+                break;
+            case TW_MT_SLA_ACK:
+                TWDR = asyncAddress;
+                break;
+            case TW_MT_DATA_ACK:
+                TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTA) | (1 << TWIE);
+                return;
+            case TW_REP_START:
+                TWDR = asyncDevice | 0x01; // device address with the read bit
+                break;
+            case TW_MR_DATA_ACK:
+            case TW_MR_DATA_NACK:
+                asyncData[asyncIndex++] = TWDR;
+                if (asyncIndex == asyncNum) {
+                    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+                    asyncStatus = TW_OK;
+                    return;
+                }
+                // fall through
+            case TW_MR_SLA_ACK:
+                // acknowledge every byte but the last one
+                if (asyncIndex == asyncNum - 1)
+                    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+                else
+                    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA) | (1 << TWIE);
+                return;
+            default:
+                TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+                asyncStatus = twst ? twst : TW_ERROR;
+                return;
+        }
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
     }
 #endif
 
@@ -140,10 +140,12 @@ class I2Cdev {
 
     #define TW_OK                   0
     #define TW_ERROR                1
+    #define TW_BUSY                 0xFF // interrupt driven transfer still running
 
     class Fastwire {
         private:
             static boolean waitInt();
+            static void waitIdle();
 
         public:
             static void setup(int khz, boolean pullup);
@@ -153,6 +155,15 @@ class I2Cdev {
             static byte readBuf(byte device, byte address, byte *data, byte num);
             static void reset();
             static byte stop();
+
+            // starts a read that runs in the TWI interrupt, poll() returns
+            // TW_BUSY until it is done, then TW_OK or an error code
+            static byte readBufAsync(byte device, byte address, byte *data, byte num);
+            static byte poll();
+
+            // frees a bus left hanging by a glitch: clocks out the byte a
+            // slave may still be sending and issues a STOP
+            static void recover();
     };
 #endif
 
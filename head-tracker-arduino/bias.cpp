@@ -0,0 +1,80 @@
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "bias.h"
+
+#define BIAS_MAGIC       0xB1
+#define BIAS_SLOTS       8   // one per BIAS_SLOT_WIDTH degrees from BIAS_MIN_TEMP
+#define BIAS_MIN_TEMP    16
+#define BIAS_SLOT_WIDTH  4
+#define BIAS_WINDOW      50  // readings averaged per estimate
+#define BIAS_STILL_RANGE 32  // raw units, 2 deg/s at 2000 deg/s, more means the head moved
+
+struct s_bias_slot {
+	unsigned char magic;
+	signed char temperature;
+	struct s_bias bias;
+};
+
+static struct s_bias_slot *slot_address(unsigned char slot) {
+	return (struct s_bias_slot *)(slot * sizeof(struct s_bias_slot));
+}
+
+bool bias_load(int temperature, struct s_bias *bias) {
+	struct s_bias_slot entry;
+	int nearest = 1000;
+
+	for (unsigned char slot = 0; slot < BIAS_SLOTS; slot++) {
+		eeprom_read_block(&entry, slot_address(slot), sizeof(entry));
+		if (entry.magic != BIAS_MAGIC)
+			continue;
+
+		int distance = abs(entry.temperature - temperature);
+		if (distance < nearest) {
+			nearest = distance;
+			*bias = entry.bias;
+		}
+	}
+	return nearest < 1000;
+}
+
+void bias_save(int temperature, const struct s_bias *bias) {
+	struct s_bias_slot entry;
+	entry.magic = BIAS_MAGIC;
+	entry.temperature = (signed char)constrain(temperature, -128, 127);
+	entry.bias = *bias;
+
+	int slot = constrain((temperature - BIAS_MIN_TEMP) / BIAS_SLOT_WIDTH, 0, BIAS_SLOTS - 1);
+	// only changed bytes are written, repeated snapshots don't wear the EEPROM
+	eeprom_update_block(&entry, slot_address(slot), sizeof(entry));
+}
+
+static long sum[3];
+static short lo[3], hi[3];
+static unsigned char count = 0;
+
+bool bias_estimate(const short *gyro, short *estimate) {
+	for (unsigned char c = 0; c < 3; c++) {
+		if (count == 0) {
+			sum[c] = 0;
+			lo[c] = hi[c] = gyro[c];
+		}
+		sum[c] += gyro[c];
+		if (gyro[c] < lo[c]) lo[c] = gyro[c];
+		if (gyro[c] > hi[c]) hi[c] = gyro[c];
+	}
+
+	for (unsigned char c = 0; c < 3; c++) {
+		if (hi[c] - lo[c] > BIAS_STILL_RANGE) {
+			count = 0;
+			return false;
+		}
+	}
+
+	if (++count < BIAS_WINDOW)
+		return false;
+
+	for (unsigned char c = 0; c < 3; c++)
+		estimate[c] = (short)((sum[c] + (sum[c] < 0 ? -BIAS_WINDOW / 2 : BIAS_WINDOW / 2)) / BIAS_WINDOW);
+	count = 0;
+	return true;
+}
@@ -0,0 +1,18 @@
+#ifndef BIAS_H
+#define BIAS_H
+
+// gyro and accel biases in raw sensor units
+struct s_bias {
+	short gyro[3];
+	short accel[3];
+};
+
+// EEPROM table indexed by temperature (degrees C), the entry nearest to
+// temperature is loaded, false if nothing has been saved yet
+bool bias_load(int temperature, struct s_bias *bias);
+void bias_save(int temperature, const struct s_bias *bias);
+
+// feeds raw gyro readings, true once a still period produced a new estimate
+bool bias_estimate(const short *gyro, short *estimate);
+
+#endif
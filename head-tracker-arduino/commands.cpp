@@ -0,0 +1,48 @@
+#include <Arduino.h>
+#include "commands.h"
+
+#define COMMAND_LENGTH 64
+
+static char line[COMMAND_LENGTH];
+static unsigned char lineLength = 0;
+
+static bool parse_command(struct s_command *command) {
+	if (lineLength < 2 || line[0] != '#')
+		return false;
+
+	command->tag = line[1];
+	command->numArgs = 0;
+
+	char *p = line + 2;
+	while (*p == ',') {
+		if (command->numArgs == COMMAND_MAX_ARGS)
+			return false;
+		char *end;
+		command->args[command->numArgs++] = strtol(p + 1, &end, 10);
+		if (end == p + 1)
+			return false;
+		p = end;
+	}
+	return *p == 0;
+}
+
+bool command_read(struct s_command *command) {
+	// at most what is buffered already, the loop never waits for the host
+	for (int n = Serial.available(); n > 0; n--) {
+		char c = Serial.read();
+		if (c == ';') {
+			line[lineLength] = 0;
+			bool valid = parse_command(command);
+			lineLength = 0;
+			if (valid)
+				return true;
+		}
+		else if (lineLength < COMMAND_LENGTH - 1) {
+			line[lineLength++] = c;
+		}
+		else {
+			lineLength = 0; // garbage, resync on the next separator
+		}
+	}
+	return false;
+}
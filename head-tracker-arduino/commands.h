@@ -0,0 +1,17 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#define COMMAND_MAX_ARGS 6
+
+// "#<tag>,<arg>,...;" sent by the host
+struct s_command {
+	char tag;
+	long args[COMMAND_MAX_ARGS];
+	unsigned char numArgs;
+};
+
+// reads what the host sent so far without blocking, true once a whole
+// command has arrived, malformed commands are skipped
+bool command_read(struct s_command *command);
+
+#endif
@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include "frames.h"
+
+// frames are assembled in the back buffer while the front one waits for
+// room in the USB endpoint, each buffer goes out with a single write
+static char buffers[2][FRAME_PACKET_SIZE];
+static unsigned char lengths[2];
+static unsigned char back = 0;
+static unsigned long backStarted;
+
+static bool write_front() {
+	unsigned char front = back ^ 1;
+	if (lengths[front] && Serial.availableForWrite() >= lengths[front]) {
+		Serial.write((const uint8_t*)buffers[front], lengths[front]);
+		lengths[front] = 0;
+	}
+	return lengths[front] == 0;
+}
+
+char* frame_begin(unsigned char maxLength) {
+	if (lengths[back] + maxLength > FRAME_PACKET_SIZE) {
+		// the host isn't reading, drop the oldest frames rather than block
+		if (!write_front())
+			lengths[back ^ 1] = 0;
+		back ^= 1;
+	}
+	if (!lengths[back])
+		backStarted = millis();
+	return buffers[back] + lengths[back];
+}
+
+void frame_end(char* end) {
+	lengths[back] = end - buffers[back];
+}
+
+char* frame_put_int(char* p, int value) {
+	itoa(value, p, 10);
+	return p + strlen(p);
+}
+
+char* frame_put_long(char* p, long value) {
+	ltoa(value, p, 10);
+	return p + strlen(p);
+}
+
+char* frame_put_text(char* p, const char* text) {
+	while (*text)
+		*p++ = *text++;
+	return p;
+}
+
+void frames_send(unsigned char holdTime) {
+	if (write_front() && lengths[back] && millis() - backStarted >= holdTime) {
+		back ^= 1;
+		write_front();
+	}
+}
@@ -0,0 +1,20 @@
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#define FRAME_PACKET_SIZE 64 // one USB full speed packet, frames are coalesced up to this size
+
+// Frames are written in place: frame_begin() returns where the next frame
+// starts, frame_end() takes the pointer behind its last character.
+// maxLength must cover the longest frame that can follow.
+char* frame_begin(unsigned char maxLength);
+void frame_end(char* end);
+
+char* frame_put_int(char* p, int value);
+char* frame_put_long(char* p, long value);
+char* frame_put_text(char* p, const char* text);
+
+// hands the assembled frames to the USB endpoint without blocking, a part
+// filled packet waits up to holdTime ms for more frames
+void frames_send(unsigned char holdTime);
+
+#endif
@@ -24,44 +24,293 @@
 /* This code is based on: https://github.com/rpicopter/ArduinoMotionSensorExample
 and was customized by Tomasz Rudzki */
 
+#include <avr/boot.h>
 #include "freeram.h"
 #include "mpu.h"
+#include "frames.h"
+#include "commands.h"
 #include "I2Cdev.h"
 
-#define DISPLAY_INTERVAL  20
+#define DISPLAY_INTERVAL  20  // the DMP FIFO rate, every packet is sent as soon as it's read
+#define STREAM_ALL_SAMPLES 0  // 1: run the DMP at 200 Hz and send every packet, both can be changed at runtime
+#define MAX_OUTPUT_RATE   200 // Hz, the DMP sample rate
+#define RESET_BUTTON_PIN  4   // to GND, asks the bridge to reset the orientation
+#define DEBOUNCE_INTERVAL 30
+#define COMPASS_INTERVAL  50  // the bridge fuses the magnetometer into the heading
+#define I2C_CLOCK         400 // kHz, the fastest the MPU-9150 supports
+#define FRAME_HOLD_TIME   0   // ms a part filled USB packet waits for more frames, raise it to send fewer packets at high rates
+#define TELEMETRY_INTERVAL 1000 // ms between "#T" health frames
+
+// feature flags, set at runtime with "#D,<flags>;"
+#define FEATURE_GYRO_CAL     1 // DMP gyro auto calibration
+#define FEATURE_ALL_SAMPLES  2 // send every packet instead of the newest one
+#define FEATURE_MAGNETOMETER 4 // "#M" frames for the bridge
+#define FEATURE_ALL (FEATURE_GYRO_CAL | FEATURE_ALL_SAMPLES | FEATURE_MAGNETOMETER)
+
+// runtime configuration, the defaults come from the constants above
+unsigned short outputRate = STREAM_ALL_SAMPLES ? MAX_OUTPUT_RATE : 1000 / DISPLAY_INTERVAL;
+unsigned short filter = 42; // mpu_init() default
+unsigned char features = FEATURE_GYRO_CAL | FEATURE_MAGNETOMETER | (STREAM_ALL_SAMPLES ? FEATURE_ALL_SAMPLES : 0);
+unsigned char frameHold = FRAME_HOLD_TIME;
 
 void setup() {
-    Fastwire::setup(400,0);
+    Fastwire::setup(I2C_CLOCK,0);
     Serial.begin(115200);
-    mympu_open(200);
+    mympu_open(outputRate);
+    pinMode(RESET_BUTTON_PIN, INPUT_PULLUP);
+}
+
+unsigned long lastButtonChange = 0;
+unsigned long lastCompass = 0;
+bool buttonPressed = false;
+
+// health counters, reported and reset with every telemetry frame
+unsigned int fifoOverflows = 0;
+unsigned int corruptPackets = 0;
+unsigned int i2cErrors = 0;
+unsigned long maxLoopMicros = 0;
+unsigned long lastTelemetry = 0;
+
+// tallies what an mpu call returned, 2 is a FIFO overflow, 3 a corrupt packet, <0 an I2C error
+void countResult(int result)
+{
+    if (result == 2)
+      fifoOverflows++;
+    else if (result == 3)
+      corruptPackets++;
+    else if (result < 0)
+      i2cErrors++;
+}
+
+void checkResetButton(unsigned long now)
+{
+    bool pressed = digitalRead(RESET_BUTTON_PIN) == LOW;
+    if (pressed != buttonPressed && (now - lastButtonChange) >= DEBOUNCE_INTERVAL)
+    {
+      buttonPressed = pressed;
+      lastButtonChange = now;
+      if (pressed)
+        frame_end(frame_put_text(frame_begin(3), "#R;"));
+    }
+}
+
+// sends a Q14 quaternion as integers, e.g. "16384,0,0,0;", the host scales it back
+void sendQuaternion(const short* q)
+{
+    char* p = frame_begin(4 * 7); // "-16384," per value
+    p = frame_put_int(p, q[0]);
+    for (int i = 1; i < 4; ++i)
+    {
+      *p++ = ',';
+      p = frame_put_int(p, q[i]);
+    }
+    *p++ = ';';
+    frame_end(p);
+}
+
+// "#C,rate,filter,features,hold;", the current configuration
+void sendConfig()
+{
+    char* p = frame_begin(2 + 4 * 6 + 1);
+    p = frame_put_text(p, "#C");
+    const int values[4] = { (int)outputRate, (int)filter, features, frameHold };
+    for (int i = 0; i < 4; ++i)
+    {
+      *p++ = ',';
+      p = frame_put_int(p, values[i]);
+    }
+    *p++ = ';';
+    frame_end(p);
+}
+
+// "#I,<serial>;", the unique serial number in the ATmega32U4 signature row
+void sendDeviceId()
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char* p = frame_begin(3 + 20 + 1);
+    p = frame_put_text(p, "#I,");
+    for (byte address = 0x0E; address <= 0x17; ++address)
+    {
+      byte value = boot_signature_byte_get(address);
+      *p++ = hex[value >> 4];
+      *p++ = hex[value & 0x0F];
+    }
+    *p++ = ';';
+    frame_end(p);
+}
+
+// "#S,<mask>,gx,gy,gz,ax,ay,az;", the self-test result and biases in raw units
+void sendSelfTest(int mask, const short* gyro, const short* accel)
+{
+    char* p = frame_begin(3 + 2 + 6 * 7 + 1);
+    p = frame_put_text(p, "#S,");
+    p = frame_put_int(p, mask);
+    for (int i = 0; i < 6; ++i)
+    {
+      *p++ = ',';
+      p = frame_put_int(p, i < 3 ? gyro[i] : accel[i - 3]);
+    }
+    *p++ = ';';
+    frame_end(p);
+}
+
+// "#T,overflows,corrupt,i2c,maxLoopUs,freeRam,temperature;", the temperature in tenths of a degree C
+void sendTelemetry()
+{
+    short temperature = 0;
+    countResult(mympu_read_temperature(&temperature));
+
+    char* p = frame_begin(2 + 3 * 6 + 11 + 2 * 7 + 1);
+    p = frame_put_text(p, "#T");
+    const unsigned int counters[3] = { fifoOverflows, corruptPackets, i2cErrors };
+    for (int i = 0; i < 3; ++i)
+    {
+      *p++ = ',';
+      p = frame_put_long(p, counters[i]);
+    }
+    *p++ = ',';
+    p = frame_put_long(p, maxLoopMicros);
+    *p++ = ',';
+    p = frame_put_int(p, freeRam());
+    *p++ = ',';
+    p = frame_put_int(p, temperature);
+    *p++ = ';';
+    frame_end(p);
+
+    fifoOverflows = corruptPackets = i2cErrors = 0;
+    maxLoopMicros = 0;
 }
 
-unsigned long lastDisplay = 0;
+// commands are answered with "#A,<tag>,<result>;", 0 if it was applied, and the configuration
+void handleCommand(struct s_command& command)
+{
+    int result = -1;
+    switch (command.tag)
+    {
+      // arguments are range checked before they are narrowed, "#F,65586;" isn't 50 Hz
+      case 'F': // output rate in Hz
+        if (command.numArgs == 1 && command.args[0] > 0 && command.args[0] <= MAX_OUTPUT_RATE
+            && (result = mympu_set_rate(command.args[0])) == 0)
+          result = mympu_get_rate(&outputRate);
+        break;
+      case 'L': // low pass filter in Hz, the MPU picks the next lower one it supports
+        if (command.numArgs == 1 && command.args[0] > 0 && command.args[0] <= 0xFFFF
+            && (result = mympu_set_lpf(command.args[0])) == 0)
+          result = mympu_get_lpf(&filter);
+        break;
+      case 'D': // feature flags
+        if (command.numArgs == 1 && (command.args[0] & ~(long)FEATURE_ALL) == 0
+            && (result = mympu_set_gyro_cal(command.args[0] & FEATURE_GYRO_CAL ? 1 : 0)) == 0)
+          features = command.args[0];
+        break;
+      case 'H': // frame hold time in ms
+        if (command.numArgs == 1 && command.args[0] >= 0 && command.args[0] <= 255)
+        {
+          frameHold = command.args[0];
+          result = 0;
+        }
+        break;
+      case 'B': // gyro x y z, accel x y z biases in q16
+        if (command.numArgs == 6)
+          result = mympu_set_biases(command.args, command.args + 3);
+        break;
+      case 'S': // self-test, the biases are applied and saved if gyro and accel passed
+      {
+        short gyro[3], accel[3];
+        int mask = mympu_calibrate(gyro, accel);
+        sendDeviceId();
+        sendSelfTest(mask, gyro, accel);
+        result = (mask & 0x03) == 0x03 ? 0 : -1;
+        break;
+      }
+      case '?':
+        sendDeviceId();
+        result = 0;
+        break;
+#ifdef MPU_PROFILE
+      case 'P': // "#P,<cycles>;", the decode cost of one FIFO packet
+      {
+        unsigned long cycles;
+        if ((result = mympu_profile_decode(100, &cycles)) == 0)
+        {
+          char* p = frame_begin(3 + 10 + 1);
+          p = frame_put_text(p, "#P,");
+          p = frame_put_long(p, cycles);
+          *p++ = ';';
+          frame_end(p);
+        }
+        break;
+      }
+#endif
+    }
+
+    char* p = frame_begin(3 + 2 + 7 + 1);
+    p = frame_put_text(p, "#A,");
+    *p++ = command.tag;
+    *p++ = ',';
+    p = frame_put_int(p, result);
+    *p++ = ';';
+    frame_end(p);
+    sendConfig();
+}
 
 void loop() {
+    unsigned long loopStarted = micros();
     unsigned long now = millis();
-    mympu_update();
+    int result = mympu_update();
+    bool newSample = result == 0;
+    countResult(result);
+    checkResetButton(now);
+    countResult(mympu_update_bias(now));
+
+    struct s_command command;
+    if (command_read(&command))
+      handleCommand(command);
+
+    if ((features & FEATURE_MAGNETOMETER) && (now - lastCompass) >= COMPASS_INTERVAL)
+    {
+      lastCompass = now;
+      result = mympu_read_compass();
+      countResult(result);
+      if (result == 0)
+      {
+        char* p = frame_begin(2 + 3 * 7 + 1);
+        p = frame_put_text(p, "#M");
+        for (int i = 0; i < 3; ++i)
+        {
+          *p++ = ',';
+          p = frame_put_int(p, mympu.mag[i]);
+        }
+        *p++ = ';';
+        frame_end(p);
+      }
+    }
+
+    if (newSample)
+    {
+      if (features & FEATURE_ALL_SAMPLES)
+        for (unsigned char i = 0; i < mympu.numSamples; i++)
+          sendQuaternion(mympu.samples[i]);
+      else
+        sendQuaternion(mympu.samples[mympu.numSamples - 1]);
+    }
+
+    if ((now - lastTelemetry) >= TELEMETRY_INTERVAL)
+    {
+      lastTelemetry = now;
+      sendTelemetry();
+    }
+
+    // the frames of this pass share as few USB packets as they fit in
+    frames_send(frameHold);
+
+    // the time spent working, sleeping in mympu_idle() doesn't count
+    unsigned long loopTime = micros() - loopStarted;
+    if (loopTime > maxLoopMicros)
+      maxLoopMicros = loopTime;
 
-    if ((now - lastDisplay) >= DISPLAY_INTERVAL)
+    if (!newSample)
     {
-      char imu_data[64];
-      char qW[8], qX[8], qY[8], qZ[8];
-      
-      dtostrf(mympu.qW, 7, 4, qW);
-      dtostrf(mympu.qX, 7, 4, qX);
-      dtostrf(mympu.qY, 7, 4, qY);
-      dtostrf(mympu.qZ, 7, 4, qZ);   
-      
-      strcpy(imu_data,qW);
-      strcat(imu_data,",");
-      strcat(imu_data,qX);
-      strcat(imu_data,",");
-      strcat(imu_data,qY);
-      strcat(imu_data,",");
-      strcat(imu_data,qZ);
-
-      Serial.write(imu_data);
-      Serial.write(";");
-      lastDisplay = now;
-    }    
+      mympu_idle();
+    }
 }
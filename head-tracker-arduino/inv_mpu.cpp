@@ -41,11 +41,27 @@
 #define i2c_read    !I2Cdev::readBytes
 #define delay_ms    delay
 
+/* Background reads, the FIFO data is transferred by the TWI interrupt. */
+#if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE
+#define i2c_read_start(a, r, l, d)  Fastwire::readBufAsync((a) << 1, r, d, l)
+#define i2c_read_status             Fastwire::poll
+#define I2C_BUSY                    TW_BUSY
+#else
+#define i2c_read_start              i2c_read
+#define i2c_read_status()           0
+#define I2C_BUSY                    0xFF
+#endif
+
 //#define MPU9250
 #define MPU9150
 
 static inline int reg_int_cb(struct int_param_s *int_param)
 {
+    /* The INT pin pulses once per DMP packet, active low unless configured otherwise. */
+    pinMode(int_param->pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(int_param->pin), int_param->cb,
+        int_param->active_low ? FALLING : RISING);
+    return 0;
 }
 #define min(a,b) ((a<b)?a:b)
 
@@ -1737,6 +1753,90 @@ int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     return 0;
 }
 
+/**
+ *  @brief      Get several unparsed packets from the FIFO in one transfer.
+ *  The FIFO count is read once and all complete packets, up to
+ *  @e max_packets, are read with a single burst from the FIFO register.
+ *  @param[in]  length      Length of one FIFO packet.
+ *  @param[in]  max_packets Capacity of @e data in packets.
+ *  @param[out] data        FIFO packets, back to back, oldest first.
+ *  @param[out] count       Number of packets read.
+ *  @param[out] more        Number of packets left in the FIFO.
+ *  @return     0 if successful, 1 if no packet was available.
+ */
+int mpu_read_fifo_burst(unsigned short length, unsigned char max_packets,
+    unsigned char *data, unsigned char *count, unsigned char *more)
+{
+    int result = mpu_start_fifo_burst(length, max_packets, data, count, more);
+    if (result)
+        return result;
+    while ((result = mpu_fifo_burst_status()) == 1)
+        ;
+    return result ? -7 : 0;
+}
+
+/**
+ *  @brief      Start reading all pending packets from the FIFO.
+ *  Same as mpu_read_fifo_burst, but only the FIFO count is read before
+ *  returning, the packets are transferred in the background. @e data must
+ *  stay valid until mpu_fifo_burst_status stops returning 1.
+ *  @param[in]  length      Length of one FIFO packet.
+ *  @param[in]  max_packets Capacity of @e data in packets.
+ *  @param[out] data        FIFO packets, filled in the background.
+ *  @param[out] count       Number of packets being read.
+ *  @param[out] more        Number of packets left in the FIFO.
+ *  @return     0 if the transfer was started, 1 if the FIFO is empty.
+ */
+int mpu_start_fifo_burst(unsigned short length, unsigned char max_packets,
+    unsigned char *data, unsigned char *count, unsigned char *more)
+{
+    unsigned char tmp[2];
+    unsigned short fifo_count, packets;
+    count[0] = 0;
+    if (!st->chip_cfg.dmp_on)
+        return -1;
+    if (!st->chip_cfg.sensors)
+        return -2;
+
+    if (i2c_read(st->hw->addr, st->reg->fifo_count_h, 2, tmp))
+        return -3;
+    fifo_count = (tmp[0] << 8) | tmp[1];
+    packets = fifo_count / length;
+    if (!packets) {
+        more[0] = 0;
+        return 1;
+    }
+    if (fifo_count > (st->hw->max_fifo >> 1)) {
+        /* FIFO is 50% full, better check overflow bit. */
+        if (i2c_read(st->hw->addr, st->reg->int_status, 1, tmp))
+            return -5;
+        if (tmp[0] & BIT_FIFO_OVERFLOW) {
+            mpu_reset_fifo();
+            return 2;
+        }
+    }
+
+    if (packets > max_packets)
+        packets = max_packets;
+    if (i2c_read_start(st->hw->addr, st->reg->fifo_r_w, packets * length, data))
+        return -7;
+    count[0] = packets;
+    more[0] = fifo_count / length - packets;
+    return 0;
+}
+
+/**
+ *  @brief      Check on a transfer started by mpu_start_fifo_burst.
+ *  @return     0 when the data is complete, 1 while it is transferred.
+ */
+int mpu_fifo_burst_status(void)
+{
+    unsigned char status = i2c_read_status();
+    if (status == I2C_BUSY)
+        return 1;
+    return status ? -1 : 0;
+}
+
 /**
  *  @brief      Set device to bypass mode.
  *  @param[in]  bypass_on   1 to enable bypass mode.
@@ -1824,7 +1924,7 @@ int mpu_set_int_latched(unsigned char enable)
     return 0;
 }
 
-#ifdef MPU_MAXIMAL
+#if defined MPU_MAXIMAL || defined MPU_SELF_TEST
 
 #ifdef MPU6050
 static int get_accel_prod_shift(float *st_shift)
@@ -2188,7 +2288,7 @@ restore:
 
     return result;
 }
-#endif // MPU_MAXIMAL
+#endif // MPU_MAXIMAL || MPU_SELF_TEST
 
 /**
  *  @brief      Write to the DMP memory.
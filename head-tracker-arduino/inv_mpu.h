@@ -31,6 +31,16 @@
 
 //#define MPU_MAXIMAL
 
+//  Define this symbol to include the self-test (mpu_run_self_test) without
+//  the other rarely-used functions
+
+#define MPU_SELF_TEST
+
+//  Define this symbol to time the FIFO packet decode on the device (dmp_profile_decode),
+//  the sketch answers "#P;" with "#P,<cycles per packet>;"
+
+//#define MPU_PROFILE
+
 //  This symbol defines how many devices are supported
 
 #define MPU_MAX_DEVICES 2
@@ -130,6 +140,11 @@ int mpu_read_fifo(short *gyro, short *accel, unsigned long *timestamp,
     unsigned char *sensors, unsigned char *more);
 int mpu_read_fifo_stream(unsigned short length, unsigned char *data,
     unsigned char *more);
+int mpu_read_fifo_burst(unsigned short length, unsigned char max_packets,
+    unsigned char *data, unsigned char *count, unsigned char *more);
+int mpu_start_fifo_burst(unsigned short length, unsigned char max_packets,
+    unsigned char *data, unsigned char *count, unsigned char *more);
+int mpu_fifo_burst_status(void);
 int mpu_reset_fifo(void);
 
 int mpu_write_mem(unsigned short mem_addr, unsigned short length,
@@ -142,8 +157,10 @@ int mpu_load_firmware(unsigned short length, const unsigned char *firmware,
 int mpu_reg_dump(void);
 int mpu_read_reg(unsigned char reg, unsigned char *data);
 
-#ifdef MPU_MAXIMAL
+#if defined MPU_MAXIMAL || defined MPU_SELF_TEST
 int mpu_run_self_test(long *gyro, long *accel);
+#endif
+#ifdef MPU_MAXIMAL
 int mpu_register_tap_cb(void (*func)(unsigned char, unsigned char));
 #endif // MPU_MAXIMAL
 
@@ -440,6 +440,7 @@ static const unsigned short sStartAddress = 0x0400;
                                      DMP_FEATURE_SEND_CAL_GYRO)
 
 #define MAX_PACKET_LENGTH   (32)
+#define MAX_BURST_LENGTH    (120)
 
 #define DMP_SAMPLE_RATE     (200)
 #define GYRO_SF             (46850825LL * 200 / DMP_SAMPLE_RATE)
@@ -452,6 +453,17 @@ static const unsigned short sStartAddress = 0x0400;
 #define QUAT_MAG_SQ_MAX         (QUAT_MAG_SQ_NORMALIZED + QUAT_ERROR_THRESH)
 #endif
 
+#define NO_FIELD            (0xFF)
+
+/* Where each field sits in a FIFO packet, set up by dmp_enable_feature. */
+struct dmp_layout_s {
+    unsigned char quat;
+    unsigned char accel;
+    unsigned char gyro;
+    unsigned char gesture;
+    short sensors;
+};
+
 struct dmp_s {
     void (*tap_cb)(unsigned char count, unsigned char direction);
     void (*android_orient_cb)(unsigned char orientation);
@@ -459,6 +471,7 @@ struct dmp_s {
     unsigned short feature_mask;
     unsigned short fifo_rate;
     unsigned char packet_length;
+    struct dmp_layout_s layout;
 };
 
 struct dmp_s dmpArray[MPU_MAX_DEVICES];
@@ -679,7 +692,8 @@ int dmp_set_fifo_rate(unsigned short rate)
     if (mpu_write_mem(CFG_6, 12, (unsigned char*)regs_end))
         return -1;
 
-    dmp->fifo_rate = rate;
+    /* The divider rounds, keep the rate the DMP actually runs at. */
+    dmp->fifo_rate = DMP_SAMPLE_RATE / (div + 1);
     return 0;
 }
 
@@ -1084,15 +1098,30 @@ int dmp_enable_feature(unsigned short mask)
     dmp->feature_mask = mask | DMP_FEATURE_PEDOMETER;
     mpu_reset_fifo();
 
+    /* The packet layout only changes here, parse_packet just unpacks it. */
     dmp->packet_length = 0;
-    if (mask & DMP_FEATURE_SEND_RAW_ACCEL)
+    dmp->layout.quat = dmp->layout.accel = NO_FIELD;
+    dmp->layout.gyro = dmp->layout.gesture = NO_FIELD;
+    dmp->layout.sensors = 0;
+    if (mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT)) {
+        dmp->layout.quat = dmp->packet_length;
+        dmp->layout.sensors |= INV_WXYZ_QUAT;
+        dmp->packet_length += 16;
+    }
+    if (mask & DMP_FEATURE_SEND_RAW_ACCEL) {
+        dmp->layout.accel = dmp->packet_length;
+        dmp->layout.sensors |= INV_XYZ_ACCEL;
         dmp->packet_length += 6;
-    if (mask & DMP_FEATURE_SEND_ANY_GYRO)
+    }
+    if (mask & DMP_FEATURE_SEND_ANY_GYRO) {
+        dmp->layout.gyro = dmp->packet_length;
+        dmp->layout.sensors |= INV_XYZ_GYRO;
         dmp->packet_length += 6;
-    if (mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT))
-        dmp->packet_length += 16;
-    if (mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
+    }
+    if (mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT)) {
+        dmp->layout.gesture = dmp->packet_length;
         dmp->packet_length += 4;
+    }
 
     return 0;
 }
@@ -1233,6 +1262,9 @@ int dmp_set_interrupt_mode(unsigned char mode)
     }
 }
 
+static int parse_packet(const unsigned char *fifo_data, short *gyro,
+    short *accel, long *quat, short *sensors);
+
 /**
  *  @brief      Get one packet from the FIFO.
  *  If @e sensors does not contain a particular sensor, disregard the data
@@ -1257,45 +1289,187 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned long *timestamp, short *sensors, unsigned char *more)
 {
     unsigned char fifo_data[MAX_PACKET_LENGTH];
-    unsigned char ii = 0;
     int errCode;
 
-    /* TODO: sensors[0] only changes when dmp_enable_feature is called. We can
-     * cache this value and save some cycles.
-     */
     sensors[0] = 0;
 
     /* Get a packet. */
     if ((errCode = mpu_read_fifo_stream(dmp->packet_length, fifo_data, more)))
         return errCode;
 
-    /* Parse DMP packet. */
-    if (dmp->feature_mask & (DMP_FEATURE_LP_QUAT | DMP_FEATURE_6X_LP_QUAT)) {
-#ifdef FIFO_CORRUPTION_CHECK
-        long quat_q14[4], quat_mag_sq;
+    if ((errCode = parse_packet(fifo_data, gyro, accel, quat, sensors)))
+        return errCode;
+
+    if (timestamp)
+	get_ms(timestamp);
+    return 0;
+}
+
+/**
+ *  @brief      Get all pending packets from the FIFO.
+ *  Reads the FIFO count once and up to @e max_packets packets in a single
+ *  I2C transfer, which saves two transactions per packet compared to
+ *  calling dmp_read_fifo until @e more is zero.
+ *  @param[out] gyro        Gyro data, 3 values per packet.
+ *  @param[out] accel       Accel data, 3 values per packet.
+ *  @param[out] quat        Quaternion data, 4 values per packet.
+ *  @param[in]  max_packets Capacity of the output arrays in packets.
+ *  @param[out] sensors     Mask of sensors read from FIFO.
+ *  @param[out] count       Number of packets read, oldest first.
+ *  @param[out] more        Number of packets left in the FIFO.
+ *  @return     0 if successful.
+ */
+int dmp_read_fifo_burst(short *gyro, short *accel, long *quat,
+    unsigned char max_packets, short *sensors, unsigned char *count,
+    unsigned char *more)
+{
+    /* I2Cdev reports the length as int8_t, bursts stay below 128 bytes. */
+    unsigned char fifo_data[MAX_BURST_LENGTH];
+    unsigned char burst = MAX_BURST_LENGTH / dmp->packet_length;
+    unsigned char ii;
+    int errCode;
+
+    sensors[0] = 0;
+    if (burst > max_packets)
+        burst = max_packets;
+
+    if ((errCode = mpu_read_fifo_burst(dmp->packet_length, burst, fifo_data,
+            count, more)))
+        return errCode;
+
+    for (ii = 0; ii < count[0]; ii++) {
+        if ((errCode = parse_packet(fifo_data + ii * dmp->packet_length,
+                gyro ? gyro + ii * 3 : 0, accel ? accel + ii * 3 : 0,
+                quat + ii * 4, sensors)))
+            return errCode;
+    }
+    return 0;
+}
+
+/* Packets of the background burst, see dmp_start_fifo_burst. */
+static unsigned char burst_data[MAX_BURST_LENGTH];
+static unsigned char burst_count;
+
+/**
+ *  @brief      Start reading all pending packets from the FIFO.
+ *  The packets are transferred in the background, the caller can do other
+ *  work until dmp_finish_fifo_burst has them.
+ *  @param[in]  max_packets Maximum number of packets to read.
+ *  @param[out] more        Number of packets left in the FIFO.
+ *  @return     0 if the transfer was started, 1 if no packet was available.
+ */
+int dmp_start_fifo_burst(unsigned char max_packets, unsigned char *more)
+{
+    unsigned char burst = MAX_BURST_LENGTH / dmp->packet_length;
+
+    if (burst > max_packets)
+        burst = max_packets;
+    return mpu_start_fifo_burst(dmp->packet_length, burst, burst_data,
+        &burst_count, more);
+}
+
+/**
+ *  @brief      Parse the packets read since dmp_start_fifo_burst.
+ *  @param[out] gyro        Gyro data, 3 values per packet.
+ *  @param[out] accel       Accel data, 3 values per packet.
+ *  @param[out] quat        Quaternion data, 4 values per packet.
+ *  @param[out] sensors     Mask of sensors read from FIFO.
+ *  @param[out] count       Number of packets read, oldest first.
+ *  @return     0 if successful, 1 while the transfer is running.
+ */
+int dmp_finish_fifo_burst(short *gyro, short *accel, long *quat,
+    short *sensors, unsigned char *count)
+{
+    unsigned char ii;
+    int errCode;
+
+    sensors[0] = 0;
+    count[0] = 0;
+    if ((errCode = mpu_fifo_burst_status()))
+        return errCode;
+
+    for (ii = 0; ii < burst_count; ii++) {
+        if ((errCode = parse_packet(burst_data + ii * dmp->packet_length,
+                gyro ? gyro + ii * 3 : 0, accel ? accel + ii * 3 : 0,
+                quat + ii * 4, sensors)))
+            return errCode;
+    }
+    count[0] = burst_count;
+    return 0;
+}
+
+#ifdef MPU_PROFILE
+/**
+ *  @brief      Time the decode of the packets read by the last burst.
+ *  Runs on the device, the packets are real FIFO data. The result only
+ *  covers the parser, not the I2C transfer.
+ *  @param[in]  repeats     Passes over the packets.
+ *  @param[out] packets     Packets decoded per pass.
+ *  @param[out] elapsed     Time of all passes in microseconds.
+ *  @return     0 if successful, -1 if no burst was read yet.
+ */
+int dmp_profile_decode(unsigned char repeats, unsigned char *packets,
+    unsigned long *elapsed)
+{
+    static volatile long sink;
+    unsigned char ii, jj;
+    long quat[4];
+    short sensors;
+    unsigned long start;
+
+    if (!burst_count)
+        return -1;
+
+    start = micros();
+    for (jj = 0; jj < repeats; jj++) {
+        for (ii = 0; ii < burst_count; ii++) {
+            parse_packet(burst_data + ii * dmp->packet_length, 0, 0, quat,
+                &sensors);
+            sink = quat[0]; /* keeps the decode from being optimised out */
+        }
+    }
+    elapsed[0] = micros() - start;
+    packets[0] = burst_count;
+    return 0;
+}
 #endif
-        quat[0] = ((long)fifo_data[0] << 24) | ((long)fifo_data[1] << 16) |
-            ((long)fifo_data[2] << 8) | fifo_data[3];
-        quat[1] = ((long)fifo_data[4] << 24) | ((long)fifo_data[5] << 16) |
-            ((long)fifo_data[6] << 8) | fifo_data[7];
-        quat[2] = ((long)fifo_data[8] << 24) | ((long)fifo_data[9] << 16) |
-            ((long)fifo_data[10] << 8) | fifo_data[11];
-        quat[3] = ((long)fifo_data[12] << 24) | ((long)fifo_data[13] << 16) |
-            ((long)fifo_data[14] << 8) | fifo_data[15];
-        ii += 16;
+
+static inline long unpack_long(const unsigned char *data)
+{
+    return ((long)data[0] << 24) | ((long)data[1] << 16) |
+        ((long)data[2] << 8) | data[3];
+}
+
+static inline short unpack_short(const unsigned char *data)
+{
+    return ((short)data[0] << 8) | data[1];
+}
+
+static int parse_packet(const unsigned char *fifo_data, short *gyro,
+    short *accel, long *quat, short *sensors)
+{
+    const struct dmp_layout_s *layout = &dmp->layout;
+
+    if (layout->quat != NO_FIELD) {
+        const unsigned char *data = fifo_data + layout->quat;
+        quat[0] = unpack_long(data);
+        quat[1] = unpack_long(data + 4);
+        quat[2] = unpack_long(data + 8);
+        quat[3] = unpack_long(data + 12);
 #ifdef FIFO_CORRUPTION_CHECK
         /* We can detect a corrupted FIFO by monitoring the quaternion data and
          * ensuring that the magnitude is always normalized to one. This
          * shouldn't happen in normal operation, but if an I2C error occurs,
          * the FIFO reads might become misaligned.
          *
-         * Let's start by scaling down the quaternion data to avoid long long
-         * math.
+         * The upper 16 bits are enough for the check, a Q14 square fits in a
+         * long without long long math.
          */
-        quat_q14[0] = quat[0] >> 16;
-        quat_q14[1] = quat[1] >> 16;
-        quat_q14[2] = quat[2] >> 16;
-        quat_q14[3] = quat[3] >> 16;
+        long quat_q14[4], quat_mag_sq;
+        quat_q14[0] = unpack_short(data);
+        quat_q14[1] = unpack_short(data + 4);
+        quat_q14[2] = unpack_short(data + 8);
+        quat_q14[3] = unpack_short(data + 12);
         quat_mag_sq = quat_q14[0] * quat_q14[0] + quat_q14[1] * quat_q14[1] +
             quat_q14[2] * quat_q14[2] + quat_q14[3] * quat_q14[3];
         if ((quat_mag_sq < QUAT_MAG_SQ_MIN) ||
@@ -1304,35 +1478,29 @@ int dmp_read_fifo(short *gyro, short *accel, long *quat,
             mpu_reset_fifo();
             sensors[0] = 0;
             return 3;
-        };
-        sensors[0] |= INV_WXYZ_QUAT;
+        }
 #endif
     }
 
-    if (dmp->feature_mask & DMP_FEATURE_SEND_RAW_ACCEL) {
-        accel[0] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
-        accel[1] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
-        accel[2] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
-        ii += 6;
-        sensors[0] |= INV_XYZ_ACCEL;
+    if (layout->accel != NO_FIELD && accel) {
+        accel[0] = unpack_short(fifo_data + layout->accel);
+        accel[1] = unpack_short(fifo_data + layout->accel + 2);
+        accel[2] = unpack_short(fifo_data + layout->accel + 4);
     }
 
-    if (dmp->feature_mask & DMP_FEATURE_SEND_ANY_GYRO) {
-        gyro[0] = ((short)fifo_data[ii+0] << 8) | fifo_data[ii+1];
-        gyro[1] = ((short)fifo_data[ii+2] << 8) | fifo_data[ii+3];
-        gyro[2] = ((short)fifo_data[ii+4] << 8) | fifo_data[ii+5];
-        ii += 6;
-        sensors[0] |= INV_XYZ_GYRO;
+    if (layout->gyro != NO_FIELD && gyro) {
+        gyro[0] = unpack_short(fifo_data + layout->gyro);
+        gyro[1] = unpack_short(fifo_data + layout->gyro + 2);
+        gyro[2] = unpack_short(fifo_data + layout->gyro + 4);
     }
 #ifdef MPU_MAXIMAL
     /* Gesture data is at the end of the DMP packet. Parse it and call
      * the gesture callbacks (if registered).
      */
-    if (dmp->feature_mask & (DMP_FEATURE_TAP | DMP_FEATURE_ANDROID_ORIENT))
-        decode_gesture(fifo_data + ii);
+    if (layout->gesture != NO_FIELD)
+        decode_gesture((unsigned char *)fifo_data + layout->gesture);
 #endif // MPU_MAXIMAL
-    if (timestamp)
-	get_ms(timestamp);
+    sensors[0] = layout->sensors;
     return 0;
 }
 
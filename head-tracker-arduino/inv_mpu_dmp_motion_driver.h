@@ -93,11 +93,28 @@ int dmp_set_pedometer_walk_time(unsigned long time);
 /* DMP gyro calibration functions. */
 int dmp_enable_gyro_cal(unsigned char enable);
 
+#ifdef MPU_PROFILE
+int dmp_profile_decode(unsigned char repeats, unsigned char *packets,
+    unsigned long *elapsed);
+#endif
+
 /* Read function. This function should be called whenever the MPU interrupt is
  * detected.
  */
 int dmp_read_fifo(short *gyro, short *accel, long *quat,
     unsigned long *timestamp, short *sensors, unsigned char *more);
+/* Reads up to max_packets packets in one I2C transfer, gyro, accel and quat
+ * hold 3, 3 and 4 values per packet.
+ */
+int dmp_read_fifo_burst(short *gyro, short *accel, long *quat,
+    unsigned char max_packets, short *sensors, unsigned char *count,
+    unsigned char *more);
+/* Same in two steps, the packets are transferred by the I2C interrupt in
+ * between. dmp_finish_fifo_burst returns 1 until they are complete.
+ */
+int dmp_start_fifo_burst(unsigned char max_packets, unsigned char *more);
+int dmp_finish_fifo_burst(short *gyro, short *accel, long *quat,
+    short *sensors, unsigned char *count);
 
 #endif  /* #ifndef _INV_MPU_DMP_MOTION_DRIVER_H_ */
 
@@ -1,4 +1,6 @@
+#include <avr/sleep.h>
 #include "mpu.h"
+#include "bias.h"
 #include "inv_mpu.h"
 #include "inv_mpu_dmp_motion_driver.h"
 
@@ -9,33 +11,70 @@
 
 #define EPSILON         0.0001f
 #define PI_2            1.57079632679489661923f
+#define COMPASS_RATE    20 // Hz, 0 leaves the magnetometer off
+#define DMP_ORIENT_IDENTITY 0x88 // inv_orientation_matrix_to_scalar() of the identity matrix
+
+#if COMPASS_RATE
+#define COMPASS_SENSORS INV_XYZ_COMPASS
+#else
+#define COMPASS_SENSORS 0
+#endif
+
+// pin wired to the MPU INT output, the FIFO is only read after it fired
+// comment out to poll the FIFO over I2C instead
+#define MPU_INT_PIN     7
+#define INT_TIMEOUT     100 // ms without a pulse, the pin isn't wired: poll until pulses show up again
+#define MIN_INT_RATE    (2 * 1000 / INT_TIMEOUT) // Hz, packets come at least twice per INT_TIMEOUT
+
+#define BIAS_INTERVAL      100    // ms between raw gyro readings for the bias estimate
+#define BIAS_SAVE_INTERVAL 600000 // ms between EEPROM snapshots of the estimate
+
+#ifdef MPU_INT_PIN
+static volatile bool dataReady = false;
+static bool useInterrupt = true;
+static unsigned long lastInterrupt = 0;
+
+static void mpu_data_ready() {
+	dataReady = true;
+}
+
+static struct int_param_s int_param = { mpu_data_ready, MPU_INT_PIN, 0, 1 };
+#define MPU_INT_PARAM   &int_param
+#else
+#define MPU_INT_PARAM   NULL
+#endif
 
 struct s_mympu mympu;
 
 struct s_quat { float w, x, y, z; }; 
 
-union u_quat {
-	struct s_quat _f;
-	long _l[4];
-} q;
-
 static int ret;
-static short gyro[3];
+static long quat[MPU_MAX_BATCH][4];
 static short sensors;
-static unsigned char fifoCount;
+static unsigned char fifoCount, packetCount;
+static bool burstPending = false; // FIFO packets are being transferred by the TWI interrupt
+static struct s_bias bias; // raw units, the last estimate and the accel bias in use
+static unsigned long lastBiasReading, lastBiasSave;
+static bool biasSaved = false;
 
 int mympu_open(unsigned int rate) {
   	mpu_select_device(0);
    	mpu_init_structures();
 
-	ret = mpu_init(NULL);
+	ret = mpu_init(MPU_INT_PARAM);
 #ifdef MPU_DEBUG
 	if (ret) return 10+ret;
 #endif
 	
-	ret = mpu_set_sensors(INV_XYZ_GYRO|INV_XYZ_ACCEL); 
+	ret = mpu_set_sensors(INV_XYZ_GYRO|INV_XYZ_ACCEL|COMPASS_SENSORS);
 #ifdef MPU_DEBUG
 	if (ret) return 20+ret;
+#endif
+#if COMPASS_RATE
+	ret = mpu_set_compass_sample_rate(COMPASS_RATE);
+#ifdef MPU_DEBUG
+	if (ret) return 25+ret;
+#endif
 #endif
 
         ret = mpu_set_gyro_fsr(FSR);
@@ -66,6 +105,13 @@ int mympu_open(unsigned int rate) {
 	if (ret) return 80+ret;
 #endif
 
+	// identity chip-to-body mapping (x 0, y 1<<3, z 2<<6), dmp_set_gyro_bias and
+	// dmp_set_accel_bias pick each axis through it, left at 0 every axis gets the x bias
+	ret = dmp_set_orientation(DMP_ORIENT_IDENTITY);
+#ifdef MPU_DEBUG
+	if (ret) return 85+ret;
+#endif
+
 	ret = dmp_set_fifo_rate(rate);
 #ifdef MPU_DEBUG
 	if (ret) return 90+ret;
@@ -76,12 +122,27 @@ int mympu_open(unsigned int rate) {
 	if (ret) return 100+ret;
 #endif
 
-	ret = dmp_enable_feature(DMP_FEATURE_6X_LP_QUAT|DMP_FEATURE_SEND_CAL_GYRO|DMP_FEATURE_GYRO_CAL);
+	// quaternion-only packets, 16 bytes each: nothing reads the gyro
+	ret = dmp_enable_feature(DMP_FEATURE_6X_LP_QUAT|DMP_FEATURE_GYRO_CAL);
 //	ret = dmp_enable_feature(DMP_FEATURE_SEND_CAL_GYRO|DMP_FEATURE_GYRO_CAL);
 #ifdef MPU_DEBUG
 	if (ret) return 110+ret;
 #endif
 
+	// biases saved at a similar temperature, the DMP doesn't have to start from zero
+	long temperature;
+	if (mpu_get_temperature(&temperature, NULL) == 0 && bias_load(temperature >> 16, &bias)) {
+		long gyro[3], accel[3];
+		for (unsigned char c = 0; c < 3; c++) {
+			gyro[c] = (long)bias.gyro[c] << 16;
+			accel[c] = (long)bias.accel[c] << 16;
+		}
+		mympu_set_biases(gyro, accel);
+	}
+
+#ifdef MPU_INT_PIN
+	lastInterrupt = millis(); // the DMP runs from here on
+#endif
 	return 0;
 }
 
@@ -125,30 +186,200 @@ static inline float wrap_180(float x) {
 }
 
 int mympu_update() {
+	if (burstPending) {
+		ret = dmp_finish_fifo_burst(NULL,NULL,quat[0],&sensors,&packetCount);
+		if (ret==1) return 1; // still transferring, the caller can do other work meanwhile
+		burstPending = false;
+		if (ret!=0) return ret;
+
+		// Q30 -> Q14 with rounding, integer only, the host does the float conversion
+		for (unsigned char i = 0; i < packetCount; i++)
+			for (unsigned char c = 0; c < 4; c++)
+				mympu.samples[i][c] = (short)((quat[i][c] + (1L << (29 - MPU_QUAT_BITS))) >> (30 - MPU_QUAT_BITS));
+		mympu.numSamples = packetCount;
+
+		// more packets are pending, read them while the caller sends these
+		if (fifoCount>0 && dmp_start_fifo_burst(MPU_MAX_BATCH,&fifoCount)==0)
+			burstPending = true;
+		return 0;
+	}
+
+#ifdef MPU_INT_PIN
+	if (dataReady) {
+		dataReady = false; // a packet arriving while draining sets it again
+		lastInterrupt = millis();
+		useInterrupt = true; // pulses are back, e.g. after a long blocking call
+	}
+	else if (useInterrupt) {
+		if (millis() - lastInterrupt < INT_TIMEOUT) return 1;
+		useInterrupt = false;
+	}
+#endif
 
-	do {
-		ret = dmp_read_fifo(gyro,NULL,q._l,NULL,&sensors,&fifoCount);
-		/* will return:
-			0 - if ok
-			1 - no packet available
-			2 - if BIT_FIFO_OVERFLOWN is set
-			3 - if frame corrupted
-		       <0 - if error
-		*/
-
-		if (ret!=0) return ret; 
-	} while (fifoCount>1);
-
-	q._f.w = (float)q._l[0] / (float)QUAT_SENS;
-	q._f.x = (float)q._l[1] / (float)QUAT_SENS;
-	q._f.y = (float)q._l[2] / (float)QUAT_SENS;
-	q._f.z = (float)q._l[3] / (float)QUAT_SENS;
-
-  // copy quaternions to mympu
-  mympu.qW = q._f.w;
-  mympu.qX = q._f.x;
-  mympu.qY = q._f.y;
-  mympu.qZ = q._f.z;
+	// only the FIFO count is read here, the packets follow in the background
+	ret = dmp_start_fifo_burst(MPU_MAX_BATCH,&fifoCount);
+	/* will return:
+		0 - if the transfer was started
+		1 - no packet available
+		2 - if BIT_FIFO_OVERFLOWN is set
+	       <0 - if error
+	*/
+	if (ret!=0) return ret;
 
+	burstPending = true;
+	return 1;
+}
+
+// sleeps until the next interrupt, the MPU or the millis() timer wakes the AVR
+void mympu_idle() {
+#ifdef MPU_INT_PIN
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	if (!useInterrupt) return;
+
+	noInterrupts();
+	// the TWI interrupt of a running burst wakes the AVR as well
+	if (!dataReady && (!burstPending || mpu_fifo_burst_status()==1)) {
+		sleep_enable();
+		interrupts(); // the instruction after sei always runs, no wake-up can be missed
+		sleep_cpu();
+		sleep_disable();
+	}
+	interrupts();
+#endif
+}
+
+// estimates the gyro bias whenever the sensor is still and snapshots it to EEPROM,
+// the DMP keeps calibrating on its own, the estimate is only used at the next start
+int mympu_update_bias(unsigned long now) {
+	if (now - lastBiasReading < BIAS_INTERVAL) return 1;
+	lastBiasReading = now;
+
+	short gyro[3];
+	ret = mpu_get_gyro_reg(gyro, NULL);
+	if (ret) return ret;
+	if (!bias_estimate(gyro, bias.gyro)) return 1;
+
+	// the first estimate is saved right away, the following ones at a slow pace
+	if (biasSaved && now - lastBiasSave < BIAS_SAVE_INTERVAL) return 1;
+
+	long temperature;
+	ret = mpu_get_temperature(&temperature, NULL);
+	if (ret) return ret;
+
+	bias_save(temperature >> 16, &bias);
+	lastBiasSave = now;
+	biasSaved = true;
 	return 0;
 }
+
+// self-test with bias calibration, the tracker has to lie still with the z axis vertical,
+// returns the self-test mask (bit 0 gyro, 1 accel, 2 compass), gyro and accel in raw units
+int mympu_calibrate(short *gyro, short *accel) {
+	long gyroBias[3], accelBias[3];
+	int result = mpu_run_self_test(gyroBias, accelBias);
+
+#ifdef MPU_INT_PIN
+	// the self-test masks the data ready interrupt for its whole run, start the timeout over
+	dataReady = false;
+	lastInterrupt = millis();
+#endif
+
+	// q16 deg/s and g to raw units << 16, as the DMP takes them
+	float gyroSens;
+	unsigned short accelSens;
+	mpu_get_gyro_sens(&gyroSens);
+	mpu_get_accel_sens(&accelSens);
+	for (unsigned char c = 0; c < 3; c++) {
+		gyroBias[c] = (long)(gyroBias[c] * gyroSens);
+		accelBias[c] *= accelSens;
+		gyro[c] = gyroBias[c] >> 16;
+		accel[c] = accelBias[c] >> 16;
+	}
+
+	// biases from a failed test aren't trusted
+	if ((result & 0x03) != 0x03) return result;
+
+	mympu_set_biases(gyroBias, accelBias);
+	for (unsigned char c = 0; c < 3; c++) {
+		bias.gyro[c] = gyro[c];
+		bias.accel[c] = accel[c];
+	}
+
+	long temperature;
+	if (mpu_get_temperature(&temperature, NULL) == 0)
+		bias_save(temperature >> 16, &bias);
+	return result;
+}
+
+int mympu_read_compass() {
+#if COMPASS_RATE
+	short raw[3];
+	ret = mpu_get_compass_reg(raw, NULL);
+	if (ret) return ret;
+
+	// the AK89xx axes are swapped against the accelerometer: x = y, y = x, z = -z
+	mympu.mag[0] = raw[1];
+	mympu.mag[1] = raw[0];
+	mympu.mag[2] = -raw[2];
+	return 0;
+#else
+	return 1; // no data rather than an error, the telemetry counts errors
+#endif
+}
+
+// die temperature in tenths of a degree C
+int mympu_read_temperature(short *tenths) {
+	long temperature;
+	ret = mpu_get_temperature(&temperature, NULL);
+	if (ret) return ret;
+
+	*tenths = (short)((temperature * 10) >> 16);
+	return 0;
+}
+
+int mympu_set_rate(unsigned short rate) {
+#ifdef MPU_INT_PIN
+	// a packet interval near INT_TIMEOUT would look like an unwired INT pin
+	if (rate < MIN_INT_RATE) return -1;
+#endif
+	if (rate < 1) return -1;
+	return dmp_set_fifo_rate(rate);
+}
+
+// the DMP divides 200 Hz, rates that don't divide it are rounded up, e.g. 150 Hz runs at 200 Hz
+int mympu_get_rate(unsigned short *rate) {
+	return dmp_get_fifo_rate(rate);
+}
+
+// rounded down to one of 188, 98, 42, 20, 10 or 5 Hz, mympu_get_lpf() has the result
+int mympu_set_lpf(unsigned short lpf) {
+	return mpu_set_lpf(lpf);
+}
+
+int mympu_get_lpf(unsigned short *lpf) {
+	return mpu_get_lpf(lpf);
+}
+
+int mympu_set_gyro_cal(unsigned char enable) {
+	return dmp_enable_gyro_cal(enable);
+}
+
+// gyro and accel biases in q16, they replace the ones the DMP is using
+int mympu_set_biases(long *gyro, long *accel) {
+	ret = dmp_set_gyro_bias(gyro);
+	if (ret) return ret;
+	return dmp_set_accel_bias(accel);
+}
+
+#ifdef MPU_PROFILE
+// CPU cycles the DMP packet decode takes per packet, measured on the last burst
+int mympu_profile_decode(unsigned char repeats, unsigned long *cycles) {
+	unsigned char packets;
+	unsigned long elapsed;
+	ret = dmp_profile_decode(repeats, &packets, &elapsed);
+	if (ret) return ret;
+
+	*cycles = elapsed * (F_CPU / 1000000L) / ((unsigned long)repeats * packets);
+	return 0;
+}
+#endif
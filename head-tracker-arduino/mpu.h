@@ -1,16 +1,40 @@
 #ifndef MPU_H
 #define MPU_H
 
+#include "inv_mpu.h" // MPU_PROFILE
+
+#define MPU_MAX_BATCH 7 // packets kept from one update, 7 quaternion packets fit in one FIFO burst
+#define MPU_QUAT_BITS 14 // fractional bits of the quaternion samples, 1.0 = 16384
+
 struct s_mympu {
 	float ypr[3];
 	float gyro[3];
-  float qW, qX, qY, qZ;
+	short mag[3];
+	short samples[MPU_MAX_BATCH][4]; // every packet read by the last update, oldest first, w x y z in Q14
+	unsigned char numSamples;
 };
 
 extern struct s_mympu mympu;
 
 int mympu_open(unsigned int rate);
 int mympu_update();
+void mympu_idle();
+int mympu_read_compass();
+int mympu_read_temperature(short *tenths);
+int mympu_update_bias(unsigned long now);
+int mympu_calibrate(short *gyro, short *accel);
+
+// runtime configuration, see the commands in the sketch
+int mympu_set_rate(unsigned short rate);
+int mympu_get_rate(unsigned short *rate);
+int mympu_set_lpf(unsigned short lpf);
+int mympu_get_lpf(unsigned short *lpf);
+int mympu_set_gyro_cal(unsigned char enable);
+int mympu_set_biases(long *gyro, long *accel);
+
+#ifdef MPU_PROFILE
+int mympu_profile_decode(unsigned char repeats, unsigned long *cycles);
+#endif
 
 #endif
 
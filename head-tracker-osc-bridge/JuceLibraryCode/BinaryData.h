@@ -8,8 +8,8 @@
 
 namespace BinaryData
 {
-    extern const char*   male_head_obj;
-    const int            male_head_objSize = 259542;
+    extern const char*   male_head_mesh;
+    const int            male_head_meshSize = 163708;
 
     extern const char*   axis_png;
     const int            axis_pngSize = 1653;
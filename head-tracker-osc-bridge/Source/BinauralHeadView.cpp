@@ -1,7 +1,15 @@
 #include "BinauralHeadView.h"
 
 BinauralHeadView::BinauralHeadView()
-	: m_frameCounter(0)
+	: m_projectionAspectRatio(0.0f)
+	, m_modelChanged(false)
+	, m_frameCounter(0)
+	, m_maxFrameRate(30)
+	, m_lastRenderRequest(0)
+	, m_renderPending(false)
+	, m_softwareRendering(false)
+	, m_contextCreated(false)
+	, m_firstShownTime(0)
 	, m_roll(0.0f)
 	, m_pitch(0.0f)
 	, m_yaw(0.0f)
@@ -10,7 +18,13 @@ BinauralHeadView::BinauralHeadView()
 
 	m_renderingContext.setRenderer(this);
 	m_renderingContext.attachTo(*this);
-	m_renderingContext.setContinuousRepainting(true);
+	m_renderingContext.setContinuousRepainting(false);
+}
+
+BinauralHeadView::~BinauralHeadView()
+{
+	stopTimer();
+	m_renderingContext.detach();
 }
 
 void BinauralHeadView::init()
@@ -28,21 +42,239 @@ void BinauralHeadView::setHeadOrientation(float roll, float pitch, float yaw)
 	//m_roll = -roll;
 	//m_pitch = -pitch;
 	//m_yaw = yaw;
+	if (m_roll == roll && m_pitch == -pitch && m_yaw == -yaw + 180.0f && !m_renderPending)
+		return;
+
 	m_roll = roll;
 	m_pitch = -pitch;
 	m_yaw = -yaw + 180.0f;
+	requestRender();
+}
+
+void BinauralHeadView::setMaxFrameRate(int framesPerSecond)
+{
+	m_maxFrameRate = jmax(1, framesPerSecond);
+}
+
+bool BinauralHeadView::setHeadModel(const File& objFile)
+{
+	OwnedArray<CustomMesh> model;
+
+	if (objFile != File())
+	{
+		WavefrontObjFile objModel;
+		if (!objFile.existsAsFile() || objModel.load(objFile).failed() || objModel.shapes.isEmpty())
+			return false;
+
+		createMeshesFromObj(objModel, model);
+	}
+
+	{
+		const ScopedLock sl(m_modelLock);
+		m_customModel.swapWith(model);
+		m_modelChanged = true;
+	}
+
+	requestRender();
+	return true;
+}
+
+void BinauralHeadView::createMeshesFromObj(const WavefrontObjFile& objFile, OwnedArray<CustomMesh>& meshes)
+{
+	// custom models come in any size and position, fit them to the built-in head
+	Range<float> x, y, z;
+	bool isFirstVertex = true;
+
+	for (auto* shape : objFile.shapes)
+	{
+		for (auto& v : shape->mesh.vertices)
+		{
+			x = isFirstVertex ? Range<float>(v.x, v.x) : x.getUnionWith(v.x);
+			y = isFirstVertex ? Range<float>(v.y, v.y) : y.getUnionWith(v.y);
+			z = isFirstVertex ? Range<float>(v.z, v.z) : z.getUnionWith(v.z);
+			isFirstVertex = false;
+		}
+	}
+
+	const float size = jmax(x.getLength(), y.getLength(), z.getLength());
+	const float scale = size > 0.0f ? 1.0f / size : 1.0f;
+	const WavefrontObjFile::Vertex defaultNormal{ 0.5f, 0.5f, 0.5f };
+
+	for (auto* shape : objFile.shapes)
+	{
+		const auto& mesh = shape->mesh;
+		auto* customMesh = meshes.add(new CustomMesh());
+		customMesh->vertices.ensureStorageAllocated(mesh.vertices.size());
+
+		for (int i = 0; i < mesh.vertices.size(); ++i)
+		{
+			const auto& v = mesh.vertices.getReference(i);
+			auto n = defaultNormal;
+			if (i < mesh.normals.size())
+			{
+				// exported normals aren't always unit length, packNormal() only clamps
+				const auto& raw = mesh.normals.getReference(i);
+				const float length = std::sqrt(raw.x * raw.x + raw.y * raw.y + raw.z * raw.z);
+				if (length > 0.0f && std::isfinite(length))
+					n = { raw.x / length, raw.y / length, raw.z / length };
+			}
+
+			customMesh->vertices.add({ { scale * (v.x - x.getStart() - 0.5f * x.getLength()),
+										 scale * (v.y - y.getStart() - 0.5f * y.getLength()),
+										 scale * (v.z - z.getStart() - 0.5f * z.getLength()) },
+									   { packNormal(n.x), packNormal(n.y), packNormal(n.z), 0 } });
+		}
+
+		customMesh->indices = mesh.indices;
+	}
+}
+
+void BinauralHeadView::setSoftwareRendering(bool shouldUseSoftwareRendering)
+{
+	if (shouldUseSoftwareRendering == m_softwareRendering)
+		return;
+
+	m_softwareRendering = shouldUseSoftwareRendering;
+
+	if (m_softwareRendering)
+	{
+		m_renderingContext.detach();
+	}
+	else
+	{
+		m_contextCreated = false;
+		m_firstShownTime = 0;
+		m_renderingContext.attachTo(*this);
+	}
+
+	requestRender();
+}
+
+bool BinauralHeadView::isUsingSoftwareRendering() const
+{
+	return m_softwareRendering;
+}
+
+bool BinauralHeadView::isSoftwareRasteriser(const String& rendererName)
+{
+	const StringArray softwareRenderers = { "llvmpipe", "softpipe", "swrast", "Software Rasterizer", "SwiftShader", "GDI Generic", "Microsoft Basic Render" };
+
+	for (auto& name : softwareRenderers)
+		if (rendererName.containsIgnoreCase(name))
+			return true;
+
+	return false;
+}
+
+void BinauralHeadView::requestRender()
+{
+	m_renderPending = true;
+
+	// hidden or minimised windows don't render, the pending frame is drawn once they show up again
+	if (!isShowing())
+		return;
+
+	const uint32 now = Time::getMillisecondCounter();
+
+	// no context after a while means OpenGL isn't available at all
+	if (!m_softwareRendering && !m_contextCreated)
+	{
+		if (m_firstShownTime == 0)
+			m_firstShownTime = now;
+		else if (now - m_firstShownTime > m_contextTimeoutMs)
+			setSoftwareRendering(true);
+	}
+	const uint32 frameInterval = 1000 / (uint32)m_maxFrameRate;
+
+	if (now - m_lastRenderRequest < frameInterval)
+	{
+		if (!isTimerRunning())
+			startTimer((int)(frameInterval - (now - m_lastRenderRequest)));
+		return;
+	}
+
+	stopTimer();
+	m_lastRenderRequest = now;
+	m_renderPending = false;
+
+	if (m_softwareRendering)
+		repaint();
+	else
+		m_renderingContext.triggerRepaint();
+}
+
+void BinauralHeadView::visibilityChanged()
+{
+	if (m_renderPending)
+		requestRender();
+}
+
+void BinauralHeadView::timerCallback()
+{
+	stopTimer();
+	requestRender();
 }
 
 void BinauralHeadView::newOpenGLContextCreated()
 {
     using namespace juce::gl;
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	createShaders();
+	m_contextCreated = true;
+
+	// a software rasteriser spends a whole core on the preview and a shader that
+	// doesn't compile can't draw it at all, both hand it over to the 2D gizmo
+	if (!isSoftwareRasteriser((const char*)glGetString(GL_RENDERER)))
+	{
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		createShaders();
+		if (m_shader != nullptr)
+			return;
+	}
+
+	MessageManager::callAsync([safeThis = Component::SafePointer<BinauralHeadView>(this)]
+	{
+		if (safeThis != nullptr)
+			safeThis->setSoftwareRendering(true);
+	});
 }
 
 void BinauralHeadView::paint(Graphics& g)
 {
-	
+	if (m_softwareRendering)
+		paintOrientationGizmo(g);
+}
+
+void BinauralHeadView::paintOrientationGizmo(Graphics& g)
+{
+	// top view of the head turned by yaw, with an artificial horizon for roll and pitch
+	const auto bounds = getLocalBounds().toFloat();
+	const auto centre = bounds.getCentre();
+	const float radius = 0.4f * jmin(bounds.getWidth(), bounds.getHeight());
+
+	g.fillAll(Colour::fromRGBA(209, 219, 244, 255));
+
+	const float roll = degreesToRadians(m_roll);
+	const float pitch = degreesToRadians(-m_pitch);
+	const float yaw = degreesToRadians(180.0f - m_yaw);
+
+	Path horizon;
+	const float horizonOffset = radius * jlimit(-1.0f, 1.0f, pitch / MathConstants<float>::halfPi);
+	horizon.addRectangle(-2.0f * radius, horizonOffset, 4.0f * radius, 2.0f * radius);
+
+	Path head;
+	head.addEllipse(centre.x - radius, centre.y - radius, 2.0f * radius, 2.0f * radius);
+
+	g.saveState();
+	g.reduceClipRegion(head);
+	g.setColour(Colour::fromRGBA(101, 128, 200, 255));
+	g.fillPath(horizon, AffineTransform::rotation(roll).translated(centre));
+	g.restoreState();
+
+	g.setColour(Colour::fromRGBA(29, 29, 29, 255));
+	g.drawEllipse(centre.x - radius, centre.y - radius, 2.0f * radius, 2.0f * radius, 1.5f);
+
+	Path nose;
+	nose.addTriangle(-0.25f * radius, -0.9f * radius, 0.25f * radius, -0.9f * radius, 0.0f, -1.25f * radius);
+	g.fillPath(nose, AffineTransform::rotation(yaw).translated(centre));
 }
 
 void BinauralHeadView::renderOpenGL()
@@ -53,7 +285,11 @@ void BinauralHeadView::renderOpenGL()
 	auto desktopScale = (float)m_renderingContext.getRenderingScale();
 
 	OpenGLHelpers::clear(Colour::fromRGBA(209, 219, 244, 255));
-	
+
+	// frames rendered before the switch to the 2D gizmo have nothing to draw with
+	if (m_shader == nullptr)
+		return;
+
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
 	glEnable(GL_BLEND);
@@ -61,20 +297,36 @@ void BinauralHeadView::renderOpenGL()
 
 	glViewport(0, 0, roundToInt(desktopScale * getWidth()), roundToInt(desktopScale * getHeight()));
 
+	{
+		const ScopedLock sl(m_modelLock);
+		if (m_modelChanged)
+		{
+			m_shape.reset(new Shape(m_renderingContext, *m_attributes, m_customModel));
+			m_modelChanged = false;
+		}
+	}
+
 	m_shader->use();
 
-	if (m_uniforms->projectionMatrix.get() != nullptr)
-		m_uniforms->projectionMatrix->setMatrix4(getProjectionMatrix().mat, 1, false);
+	// uniform values live in the program, only the model matrix changes from frame to frame
+	const float aspectRatio = getLocalBounds().toFloat().getAspectRatio(false);
+	if (aspectRatio != m_projectionAspectRatio)
+	{
+		m_projectionAspectRatio = aspectRatio;
+
+		if (m_uniforms->projectionMatrix.get() != nullptr)
+			m_uniforms->projectionMatrix->setMatrix4(getProjectionMatrix().mat, 1, false);
 
-	if (m_uniforms->viewMatrix.get() != nullptr)
-		m_uniforms->viewMatrix->setMatrix4(getViewMatrix().mat, 1, false);
+		if (m_uniforms->viewMatrix.get() != nullptr)
+			m_uniforms->viewMatrix->setMatrix4(getViewMatrix().mat, 1, false);
+
+		if (m_uniforms->lightPosition.get() != nullptr)
+			m_uniforms->lightPosition->set(0.0f, 10.0f, 15.0f, 0.0f);
+	}
 
 	if (m_uniforms->modelMatrix.get() != nullptr)
 		m_uniforms->modelMatrix->setMatrix4(getModelMatrix().mat, 1, false);
 
-	if (m_uniforms->lightPosition.get() != nullptr)
-		m_uniforms->lightPosition->set(0.0f, 10.0f, 15.0f, 0.0f);
-
 	m_shape->draw(m_renderingContext, *m_attributes);
 
 	// Reset the element buffers so child Components draw correctly
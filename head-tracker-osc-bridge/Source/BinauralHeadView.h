@@ -7,32 +7,37 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "WavefrontObjParser.h"
 
-inline String loadEntireAssetIntoString(const char* assetName)
-{
-	int size;
-	const char* headModel = BinaryData::getNamedResource("male_head_obj", size);
-
-	MemoryInputStream mem(headModel, size, false);
-
-	return mem.readString();
-}
-
 class BinauralHeadView
 	: public Component
 	, public OpenGLRenderer
+	, private Timer
 {
 public:
 	BinauralHeadView();
+	~BinauralHeadView();
 	void init();
 	void deinit();
 
 	void setHeadOrientation(float roll, float pitch, float yaw);
+	void setMaxFrameRate(int framesPerSecond);
+
+	// loads a custom OBJ head model, an empty file restores the built-in head
+	bool setHeadModel(const File& objFile);
+
+	// a 2D gizmo drawn with Graphics, picked automatically when there's no hardware OpenGL
+	void setSoftwareRendering(bool shouldUseSoftwareRendering);
+	bool isUsingSoftwareRendering() const;
 
 private:
 	void newOpenGLContextCreated() override;
 	void paint(Graphics& g) override;
 	void renderOpenGL() override;
 	void openGLContextClosing() override;
+	void visibilityChanged() override;
+	void timerCallback() override;
+	void requestRender();
+	void paintOrientationGizmo(Graphics& g);
+	static bool isSoftwareRasteriser(const String& rendererName);
 
 	Matrix3D<float> getProjectionMatrix() const
 	{
@@ -79,7 +84,7 @@ private:
 			"\n"
 			"void main()\n"
 			"{\n"
-			"	float l = lightIntensity * 0.1;\n"
+			"	float l = lightIntensity * 0.02;\n"
 			"	vec4 colour = vec4(l, l, l, 1.0);\n"
 			"\n"
 			"	gl_FragColor = colour;\n"
@@ -99,9 +104,13 @@ private:
 			m_shader.reset(newShader.release());
 			m_shader->use();
 
-			m_shape.reset(new Shape(m_renderingContext));
 			m_attributes.reset(new Attributes(m_renderingContext, *m_shader));
 			m_uniforms.reset(new Uniforms(m_renderingContext, *m_shader));
+			m_projectionAspectRatio = 0.0f;
+
+			const ScopedLock sl(m_modelLock);
+			m_shape.reset(new Shape(m_renderingContext, *m_attributes, m_customModel));
+			m_modelChanged = false;
 
 			statusText = "GLSL: v" + String(OpenGLShaderProgram::getLanguageVersion(), 2);
 		}
@@ -111,14 +120,35 @@ private:
 		}
 	}
 
+	// matches the interleaved layout of the mesh blob written by Tools/obj2mesh.py
 	struct Vertex
 	{
 		float position[3];
-		float normal[3];
-		float colour[4];
-		float texCoord[2];
+		int8 normal[4]; // normalised, the fourth byte is padding
 	};
 
+	static int8 packNormal(float component)
+	{
+		return (int8)jlimit(-127, 127, roundToInt(component * 127.0f));
+	}
+
+	static bool supportsVertexArrays()
+	{
+		// vertex array objects are core since OpenGL 3.0 and OpenGL ES 3.0
+		using namespace juce::gl;
+		const String version((const char*)glGetString(GL_VERSION));
+		return version.fromFirstOccurrenceOf("OpenGL ES ", false, false).getIntValue() >= 3
+			|| (!version.startsWith("OpenGL ES") && version.getIntValue() >= 3);
+	}
+
+	struct CustomMesh
+	{
+		Array<Vertex> vertices;
+		Array<juce::uint32> indices;
+	};
+
+	static void createMeshesFromObj(const WavefrontObjFile& objFile, OwnedArray<CustomMesh>& meshes);
+
 	// This class just manages the attributes that the shaders use.
 	struct Attributes
 	{
@@ -126,8 +156,6 @@ private:
 		{
 			position.reset(createAttribute(openGLContext, shaderProgram, "position"));
 			normal.reset(createAttribute(openGLContext, shaderProgram, "normal"));
-			sourceColour.reset(createAttribute(openGLContext, shaderProgram, "sourceColour"));
-			textureCoordIn.reset(createAttribute(openGLContext, shaderProgram, "textureCoordIn"));
 		}
 
 		void enable(OpenGLContext& glContext)
@@ -141,32 +169,18 @@ private:
 
 			if (normal.get() != nullptr)
 			{
-				glContext.extensions.glVertexAttribPointer(normal->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)(sizeof(float) * 3));
+				glContext.extensions.glVertexAttribPointer(normal->attributeID, 3, GL_BYTE, GL_TRUE, sizeof(Vertex), (GLvoid*)(sizeof(float) * 3));
 				glContext.extensions.glEnableVertexAttribArray(normal->attributeID);
 			}
-
-			if (sourceColour.get() != nullptr)
-			{
-				glContext.extensions.glVertexAttribPointer(sourceColour->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)(sizeof(float) * 6));
-				glContext.extensions.glEnableVertexAttribArray(sourceColour->attributeID);
-			}
-
-			if (textureCoordIn.get() != nullptr)
-			{
-				glContext.extensions.glVertexAttribPointer(textureCoordIn->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)(sizeof(float) * 10));
-				glContext.extensions.glEnableVertexAttribArray(textureCoordIn->attributeID);
-			}
 		}
 
 		void disable(OpenGLContext& glContext)
 		{
 			if (position.get() != nullptr)       glContext.extensions.glDisableVertexAttribArray(position->attributeID);
 			if (normal.get() != nullptr)         glContext.extensions.glDisableVertexAttribArray(normal->attributeID);
-			if (sourceColour.get() != nullptr)   glContext.extensions.glDisableVertexAttribArray(sourceColour->attributeID);
-			if (textureCoordIn.get() != nullptr) glContext.extensions.glDisableVertexAttribArray(textureCoordIn->attributeID);
 		}
 
-		std::unique_ptr<OpenGLShaderProgram::Attribute> position, normal, sourceColour, textureCoordIn;
+		std::unique_ptr<OpenGLShaderProgram::Attribute> position, normal;
 
 	private:
 		static OpenGLShaderProgram::Attribute* createAttribute(OpenGLContext& openGLContext,
@@ -206,11 +220,43 @@ private:
 
 	struct Shape
 	{
-		Shape(OpenGLContext& glContext)
+		Shape(OpenGLContext& glContext, Attributes& glAttributes, const OwnedArray<CustomMesh>& customModel)
+			: useVertexArrays(supportsVertexArrays())
 		{
-			if (shapeFile.load(loadEntireAssetIntoString("male_head.obj")).wasOk())
-				for (auto* shapeVertices : shapeFile.shapes)
-					vertexBuffers.add(new VertexBuffer(glContext, *shapeVertices));
+			for (auto* mesh : customModel)
+				vertexBuffers.add(new VertexBuffer(glContext, glAttributes, useVertexArrays, mesh->vertices.getRawDataPointer(),
+					mesh->vertices.size(), mesh->indices.getRawDataPointer(), mesh->indices.size()));
+
+			if (!customModel.isEmpty())
+				return;
+
+			// the mesh blob is uploaded straight from the binary data, see Tools/obj2mesh.py
+			int size;
+			const char* data = BinaryData::getNamedResource("male_head_mesh", size);
+
+			if (data == nullptr || size < 12 || memcmp(data, "HTMH", 4) != 0 || ByteOrder::littleEndianInt(data + 4) != 2)
+			{
+				jassertfalse; // regenerate the mesh with Tools/obj2mesh.py
+				return;
+			}
+
+			const int numShapes = (int)ByteOrder::littleEndianInt(data + 8);
+			int offset = 12;
+
+			for (int i = 0; i < numShapes && offset + 8 <= size; ++i)
+			{
+				const int numVertices = (int)ByteOrder::littleEndianInt(data + offset);
+				const int numIndices = (int)ByteOrder::littleEndianInt(data + offset + 4);
+				const int verticesOffset = offset + 8;
+				const int indicesOffset = verticesOffset + numVertices * (int)sizeof(Vertex);
+				offset = indicesOffset + numIndices * (int)sizeof(juce::uint32);
+
+				if (offset > size)
+					break;
+
+				vertexBuffers.add(new VertexBuffer(glContext, glAttributes, useVertexArrays, data + verticesOffset, numVertices,
+					data + indicesOffset, numIndices));
+			}
 		}
 
 		void draw(OpenGLContext& glContext, Attributes& glAttributes)
@@ -218,42 +264,67 @@ private:
             using namespace juce::gl;
 			for (auto* vertexBuffer : vertexBuffers)
 			{
-				vertexBuffer->bind();
-
-				glAttributes.enable(glContext);
-				glDrawElements(GL_TRIANGLES, vertexBuffer->numIndices, GL_UNSIGNED_INT, nullptr);
-				glAttributes.disable(glContext);
+				if (useVertexArrays)
+				{
+					// the attribute layout was recorded in the vertex array when the buffer was created
+					glBindVertexArray(vertexBuffer->vertexArray);
+					glDrawElements(GL_TRIANGLES, vertexBuffer->numIndices, GL_UNSIGNED_INT, nullptr);
+				}
+				else
+				{
+					vertexBuffer->bind();
+
+					glAttributes.enable(glContext);
+					glDrawElements(GL_TRIANGLES, vertexBuffer->numIndices, GL_UNSIGNED_INT, nullptr);
+					glAttributes.disable(glContext);
+				}
 			}
+
+			if (useVertexArrays)
+				glBindVertexArray(0);
 		}
 
 	private:
 		struct VertexBuffer
 		{
-			VertexBuffer(OpenGLContext& context, WavefrontObjFile::Shape& aShape)
-				: openGLContext(context)
+			// the blob is little endian like every platform the bridge runs on
+			VertexBuffer(OpenGLContext& context, Attributes& glAttributes, bool useVertexArray,
+				const void* vertices, int numVertices, const void* indices, int numIndicesToUse)
+				: numIndices(numIndicesToUse)
+				, openGLContext(context)
 			{
                 using namespace juce::gl;
-				numIndices = aShape.mesh.indices.size();
+				if (useVertexArray)
+				{
+					glGenVertexArrays(1, &vertexArray);
+					glBindVertexArray(vertexArray);
+				}
 
 				openGLContext.extensions.glGenBuffers(1, &vertexBuffer);
 				openGLContext.extensions.glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-
-				Array<Vertex> vertices;
-				createVertexListFromMesh(aShape.mesh, vertices, Colours::green);
-
 				openGLContext.extensions.glBufferData(GL_ARRAY_BUFFER,
-					static_cast<GLsizeiptr> (static_cast<size_t> (vertices.size()) * sizeof(Vertex)),
-					vertices.getRawDataPointer(), GL_STATIC_DRAW);
+					static_cast<GLsizeiptr> (static_cast<size_t> (numVertices) * sizeof(Vertex)),
+					vertices, GL_STATIC_DRAW);
 
 				openGLContext.extensions.glGenBuffers(1, &indexBuffer);
 				openGLContext.extensions.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 				openGLContext.extensions.glBufferData(GL_ELEMENT_ARRAY_BUFFER,
 					static_cast<GLsizeiptr> (static_cast<size_t> (numIndices) * sizeof(juce::uint32)),
-					aShape.mesh.indices.getRawDataPointer(), GL_STATIC_DRAW);
+					indices, GL_STATIC_DRAW);
+
+				if (useVertexArray)
+				{
+					glAttributes.enable(openGLContext);
+					glBindVertexArray(0);
+				}
 			}
 
 			~VertexBuffer()
 			{
+                using namespace juce::gl;
+				if (vertexArray != 0)
+					glDeleteVertexArrays(1, &vertexArray);
+
 				openGLContext.extensions.glDeleteBuffers(1, &vertexBuffer);
 				openGLContext.extensions.glDeleteBuffers(1, &indexBuffer);
 			}
@@ -265,34 +336,15 @@ private:
 				openGLContext.extensions.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 			}
 
-			GLuint vertexBuffer, indexBuffer;
+			GLuint vertexArray = 0, vertexBuffer, indexBuffer;
 			int numIndices;
 			OpenGLContext& openGLContext;
 
 			JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VertexBuffer)
 		};
 
-		WavefrontObjFile shapeFile;
+		const bool useVertexArrays;
 		OwnedArray<VertexBuffer> vertexBuffers;
-
-		static void createVertexListFromMesh(const WavefrontObjFile::Mesh& mesh, Array<Vertex>& list, Colour colour)
-		{
-			auto scale = 0.2f;
-			WavefrontObjFile::TextureCoord defaultTexCoord{ 0.5f, 0.5f };
-			WavefrontObjFile::Vertex defaultNormal{ 0.5f, 0.5f, 0.5f };
-
-			for (auto i = 0; i < mesh.vertices.size(); ++i)
-			{
-				const auto& v = mesh.vertices.getReference(i);
-				const auto& n = i < mesh.normals.size() ? mesh.normals.getReference(i) : defaultNormal;
-				const auto& tc = i < mesh.textureCoords.size() ? mesh.textureCoords.getReference(i) : defaultTexCoord;
-
-				list.add({ { scale * v.x, scale * v.y, scale * v.z, },
-							{ scale * n.x, scale * n.y, scale * n.z, },
-							{ colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha() },
-							{ tc.x, tc.y } });
-			}
-		}
 	};
 	
 	const char* m_vertexShader;
@@ -302,6 +354,11 @@ private:
 	std::unique_ptr<Shape> m_shape;
 	std::unique_ptr<Attributes> m_attributes;
 	std::unique_ptr<Uniforms> m_uniforms;
+	float m_projectionAspectRatio; // the constant uniforms are only set when the shader or the size changes
+
+	CriticalSection m_modelLock;
+	OwnedArray<CustomMesh> m_customModel;
+	bool m_modelChanged;
 
 	String m_newVertexShader;
 	String m_newFragmentShader;
@@ -309,6 +366,17 @@ private:
 	OpenGLContext m_renderingContext;
 	int m_frameCounter;
 
+	// frames are only rendered when the pose changes, at most m_maxFrameRate per second
+	int m_maxFrameRate;
+	uint32 m_lastRenderRequest;
+	bool m_renderPending;
+
+	// software fallback
+	bool m_softwareRendering;
+	std::atomic<bool> m_contextCreated;
+	uint32 m_firstShownTime;
+	const uint32 m_contextTimeoutMs = 3000;
+
 	float m_roll;
 	float m_pitch;
 	float m_yaw;
@@ -25,52 +25,74 @@
 
 Bridge::Bridge()
 {
-    sender.connect(m_ipAddress, m_oscPortNumber);
+    m_activeSource = createTracker(0);
+    m_oscInputs.add(new OscInput(*createTracker(0), m_trackerLock));
+    setInputPriorities(0, 1);
+    setStaleTimeout(100000);
+    updateOutputs();
+    m_controlReceiver.addListener(this);
 }
 
 Bridge::~Bridge()
 {
-	if (m_serialPortConnected)
-	{
-		disconnectSerial();
-	}
-    disconnectOscReceiver();
-    sender.disconnect();
+    stopTimer();
+    disconnectControlReceiver();
+    m_controlReceiver.removeListener(this);
+    m_oscInputs.clear();
+    {
+        const ScopedLock sl(m_trackerLock);
+        m_trackers.clear();
+    }
 }
 
-bool Bridge::connectOscReceiver()
+bool Bridge::connectOscReceiver(int portNumber, const String& address)
 {
-    bool isConnected = connect(8888); // osc input at port 8888
-    addListener(this);
-    return isConnected;
+    return m_oscInputs[0]->connect(portNumber, address);
 }
 
 void Bridge::disconnectOscReceiver()
 {
-    disconnect();
+    m_oscInputs[0]->disconnect();
 }
 
-void Bridge::oscMessageReceived(const OSCMessage& message)
+bool Bridge::isOscReceiverConnected()
 {
-    if (message.getAddressPattern().toString() == "/bridge/quat" && message.size() == 4)
+    return m_oscInputs[0]->isConnected();
+}
+
+bool Bridge::addOscInput(int portNumber, const String& address, int trackerId, int priority)
+{
+    Tracker* tracker;
     {
-		qlW = message[0].getFloat32();
-		qlX = message[1].getFloat32();
-		qlY = message[2].getFloat32();
-		qlZ = message[3].getFloat32();
-		pushQuaternionVector();
+        const ScopedLock sl(m_trackerLock);
+        tracker = createTracker(trackerId);
+        tracker->setPriority(priority);
+        updateOutputs();
     }
+
+    auto* input = m_oscInputs.add(new OscInput(*tracker, m_trackerLock));
+    return input->connect(portNumber, address);
+}
+
+void Bridge::setInputPriorities(int serialPriority, int oscPriority)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_trackers[0]->setPriority(serialPriority);
+    m_oscInputs[0]->getTracker().setPriority(oscPriority);
 }
 
-void Bridge::oscBundleReceived(const OSCBundle& bundle)
+void Bridge::setStaleTimeout(int microseconds)
 {
-    OSCBundle::Element elem = bundle[0];
-    oscMessageReceived(elem.getMessage());
+    const ScopedLock sl(m_trackerLock);
+    m_staleTicks = Time::getHighResolutionTicksPerSecond() * microseconds / 1000000;
 }
 
 StringArray Bridge::getPortInfo()
 {
-    port_number = comEnumerate();
+    const ScopedLock sl(m_trackerLock);
+    trackerRescanPorts();
+
+    portlist.clear();
     for(port_index=0; port_index < port_number; port_index++)
         portlist.set(comGetInternalName(port_index),comGetPortName(port_index));
     return portlist.getAllValues();
@@ -78,165 +100,416 @@ StringArray Bridge::getPortInfo()
 
 bool Bridge::connectSerial()
 {
-    port_state = comOpen(PortN, BaudR);
-    if (port_state == 1)
-    {
-        m_serialPortConnected = true;
-        startTimer(10);
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    const ScopedLock sl(m_trackerLock);
+    const char* portName = comGetPortName(PortN);
+    bool isConnected = portName != nullptr && m_trackers[0]->open(portName, BaudR);
+    if (!isConnected)
+        m_trackers[0]->close();
+    updateTimer();
+    return isConnected;
 }
 
 void Bridge::disconnectSerial()
 {
-    comClose(PortN);
-    m_serialPortConnected = false;
-    stopTimer();
+    const ScopedLock sl(m_trackerLock);
+    m_trackers[0]->close();
+    updateTimer();
 }
 
 bool Bridge::isSerialConnected()
 {
-    return m_serialPortConnected;
+    return m_trackers[0]->isOpen();
 }
 
-void Bridge::timerCallback()
+bool Bridge::isReconnecting()
+{
+    return m_trackers[0]->isReconnecting();
+}
+
+void Bridge::setAutoReconnect(bool shouldReconnect)
+{
+    const ScopedLock sl(m_trackerLock);
+    for (auto* tracker : m_trackers)
+        tracker->setAutoReconnect(shouldReconnect);
+}
+
+int Bridge::addTracker(const String& portName)
+{
+    const ScopedLock sl(m_trackerLock);
+    if (isPortClaimed(portName, nullptr))
+        return -1;
+
+    // the tracker keeps waiting for its port if it's not plugged in yet
+    auto* tracker = createTracker(m_nextTrackerId++);
+    tracker->open(portName, BaudR);
+    updateOutputs();
+    updateTimer();
+    return tracker->getId();
+}
+
+void Bridge::removeTracker(int trackerId)
 {
-	if(m_serialPortConnected)
-    {    
-        char readBuffer[128];
-        comRead(PortN, readBuffer, 128);
-        
-        if(strlen(readBuffer) != 0)
+    const ScopedLock sl(m_trackerLock);
+    for (int i = 1; i < m_trackers.size(); ++i)
+    {
+        // trackers fed by OSC inputs live as long as their input
+        if (m_trackers[i]->getId() == trackerId && !isOscInputTracker(m_trackers[i]))
         {
-            StringArray m_quatsReceived = StringArray::fromTokens(readBuffer, ",", "\"");
-            if(m_quatsReceived.size() == 4)
-            {
-                qlW = m_quatsReceived[0].getFloatValue();
-                qlX = m_quatsReceived[1].getFloatValue();
-                qlY = m_quatsReceived[2].getFloatValue();
-                qlZ = m_quatsReceived[3].getFloatValue();
-                pushQuaternionVector();
-            }
+            m_trackers.remove(i);
+            m_outputs.remove(i);
+            break;
         }
-	}
+    }
+    updateTimer();
 }
 
-void Bridge::pushQuaternionVector()
+int Bridge::getNumTrackers()
 {
-    // normalization (just in case)
-    double magnitude = sqrt(qlW * qlW + qlX * qlX + qlY * qlY + qlZ * qlZ);
-    qlW /= magnitude;
-    qlX /= magnitude;
-    qlY /= magnitude;
-    qlZ /= magnitude;
+    return m_trackers.size();
+}
 
-    qW = qbW * qlW + qbX * qlX + qbY * qlY + qbZ * qlZ;
-    qX = qbW * qlX - qbX * qlW - qbY * qlZ + qbZ * qlY;
-    qY = qbW * qlY + qbX * qlZ - qbY * qlW - qbZ * qlX;
-    qZ = qbW * qlZ - qbX * qlY + qbY * qlX - qbZ * qlW;
+void Bridge::timerCallback()
+{
+    // all serial handles are non-blocking, one pass services every tracker
+    const ScopedLock sl(m_trackerLock);
+    const uint32 now = Time::getMillisecondCounter();
+    for (auto* tracker : m_trackers)
+        tracker->service(now);
+}
 
-    if (m_quatsActive)
+void Bridge::updateTimer()
+{
+    for (auto* tracker : m_trackers)
     {
-        const Array<float> quats = { qW, qX, qY, qZ };
-        if (m_quatsOrder.size() == 4 && m_quatsSigns.size() == 4)
+        if (tracker->isOpen())
         {
-            sender.send(m_quatsOscAddress,
-                m_quatsSigns[0] * quats[m_quatsOrder[0]],
-                m_quatsSigns[1] * quats[m_quatsOrder[1]],
-                m_quatsSigns[2] * quats[m_quatsOrder[2]],
-                m_quatsSigns[3] * quats[m_quatsOrder[3]]);
+            if (!isTimerRunning())
+                startTimer(10);
+            return;
         }
     }
+    stopTimer();
+}
+
+void Bridge::trackerRescanPorts()
+{
+    port_number = comEnumerate();
+    for (auto* tracker : m_trackers)
+        tracker->refreshPortIndex();
+}
+
+void Bridge::trackerResetRequested(Tracker& tracker)
+{
+    resetOrientation(tracker.getId());
+}
+
+void Bridge::trackerTelemetryReceived(Tracker& tracker)
+{
+    if (!m_telemetryActive)
+        return;
+
+    // overflows, corrupt packets, I2C errors, max loop time in us, free RAM in bytes, temperature in degrees C
+    const auto& telemetry = tracker.getTelemetry();
+    const float values[6] = { (float)telemetry.fifoOverflows, (float)telemetry.corruptPackets, (float)telemetry.i2cErrors,
+        (float)telemetry.maxLoopMicros, (float)telemetry.freeRam, (float)telemetry.temperature };
+
+    auto& output = *m_outputs[m_trackers.indexOf(&tracker)];
+    for (int i = 0; i < 6; ++i)
+        output.telemetry.setFloat(i, values[i]);
+    m_router.getDestination(tracker.getId()).send(output.telemetry);
+}
+
+bool Bridge::isPortClaimed(const String& portName, const Tracker* except)
+{
+    for (auto* tracker : m_trackers)
+        if (tracker != except && tracker->isUsingPort(portName))
+            return true;
+    return false;
+}
+
+void Bridge::updateOutputs()
+{
+    // expand the address templates once, sending only patches the values
+    m_outputs.clear();
+    for (auto* tracker : m_trackers)
+    {
+        auto* output = m_outputs.add(new TrackerOutput());
+        output->quats.prepare(OscAddressTemplate::expand(m_quatsOscAddress, tracker->getId()), 4);
+        output->roll.prepare(OscAddressTemplate::expand(m_rollOscAddress, tracker->getId()), 1);
+        output->pitch.prepare(OscAddressTemplate::expand(m_pitchOscAddress, tracker->getId()), 1);
+        output->yaw.prepare(OscAddressTemplate::expand(m_yawOscAddress, tracker->getId()), 1);
+        output->rpy.prepare(OscAddressTemplate::expand(m_rpyOscAddress, tracker->getId()), 3);
+        output->telemetry.prepare(OscAddressTemplate::expand(m_telemetryOscAddress, tracker->getId()), 6);
+    }
+}
 
-    updateEuler();
+Tracker* Bridge::createTracker(int trackerId)
+{
+    auto* tracker = m_trackers.add(new Tracker(trackerId, *this));
+    tracker->setDriftCompensation(m_driftSettings);
+    tracker->setResetTransition(m_resetTransitionSeconds, m_resetAveragingSeconds);
+    return tracker;
+}
+
+bool Bridge::isOscInputTracker(const Tracker* tracker)
+{
+    for (auto* input : m_oscInputs)
+        if (&input->getTracker() == tracker)
+            return true;
+
+    return false;
+}
+
+bool Bridge::isSelectedSource(Tracker& tracker)
+{
+    // a fresh source with a higher priority, or an equal one listed earlier, takes precedence
+    const int64 now = Time::getHighResolutionTicks();
+    const int index = m_trackers.indexOf(&tracker);
+
+    for (int i = 0; i < m_trackers.size(); ++i)
+    {
+        auto* source = m_trackers[i];
+        if (source == &tracker
+            || source->getId() != tracker.getId()
+            || now - source->getLastSampleTicks() >= m_staleTicks)
+            continue;
+
+        // sources listed after this one are checked as well, they may have the better priority
+        if (source->getPriority() < tracker.getPriority()
+            || (source->getPriority() == tracker.getPriority() && i < index))
+            return false;
+    }
+
+    return true;
+}
+
+void Bridge::trackerOrientationChanged(Tracker& tracker)
+{
+    if (!isSelectedSource(tracker))
+        return;
+
+    auto& output = *m_outputs[m_trackers.indexOf(&tracker)];
+    auto& destination = m_router.getDestination(tracker.getId());
+
+    if (m_quatsActive && m_quatsOrder.size() == 4 && m_quatsSigns.size() == 4)
+    {
+        const float quats[4] = { (float)tracker.getQW(), (float)tracker.getQX(), (float)tracker.getQY(), (float)tracker.getQZ() };
+        for (int i = 0; i < 4; ++i)
+            output.quats.setFloat(i, m_quatsSigns[i] * quats[m_quatsOrder[i]]);
+        destination.send(output.quats);
+    }
 
     // Map and send rpy OSC
-    m_rollOSC = (float)jmap(m_roll, (float)-180, (float)180, m_rollOscMin, m_rollOscMax);
-    m_pitchOSC = (float)jmap(m_pitch, (float)-180, (float)180, m_pitchOscMin, m_pitchOscMax);
-    m_yawOSC = (float)jmap(m_yaw, (float)-180, (float)180, m_yawOscMin, m_yawOscMax);
-    if (m_rollActive) sender.send(m_rollOscAddress, m_rollOSC);
-    if (m_pitchActive) sender.send(m_pitchOscAddress, m_pitchOSC);
-    if (m_yawActive) sender.send(m_yawOscAddress, m_yawOSC);
-    if (m_rpyActive)
+    const float rpy[3] = {
+        (float)jmap(tracker.getRoll(), (float)-180, (float)180, m_rollOscMin, m_rollOscMax),
+        (float)jmap(tracker.getPitch(), (float)-180, (float)180, m_pitchOscMin, m_pitchOscMax),
+        (float)jmap(tracker.getYaw(), (float)-180, (float)180, m_yawOscMin, m_yawOscMax) };
+
+    if (m_rollActive) { output.roll.setFloat(0, rpy[0]); destination.send(output.roll); }
+    if (m_pitchActive) { output.pitch.setFloat(0, rpy[1]); destination.send(output.pitch); }
+    if (m_yawActive) { output.yaw.setFloat(0, rpy[2]); destination.send(output.yaw); }
+    if (m_rpyActive && m_rpyOrder[0] >= 0)
     {
-        if (m_rpyOscKey == "rpy") sender.send(m_rpyOscAddress, m_rollOSC, m_pitchOSC, m_yawOSC);
-        else if (m_rpyOscKey == "ypr") sender.send(m_rpyOscAddress, m_yawOSC, m_pitchOSC, m_rollOSC);
-        else if (m_rpyOscKey == "pry") sender.send(m_rpyOscAddress, m_pitchOSC, m_rollOSC, m_yawOSC);
-        else if (m_rpyOscKey == "yrp") sender.send(m_rpyOscAddress, m_yawOSC, m_rollOSC, m_pitchOSC);
-        else if (m_rpyOscKey == "ryp") sender.send(m_rpyOscAddress, m_rollOSC, m_yawOSC, m_pitchOSC);
-        else if (m_rpyOscKey == "pyr") sender.send(m_rpyOscAddress, m_pitchOSC, m_yawOSC, m_rollOSC);
+        for (int i = 0; i < 3; ++i)
+            output.rpy.setFloat(i, rpy[m_rpyOrder[i]]);
+        destination.send(output.rpy);
+    }
+
+    if (tracker.getId() == 0)
+    {
+        m_activeSource = &tracker;
+        m_rollOSC = rpy[0];
+        m_pitchOSC = rpy[1];
+        m_yawOSC = rpy[2];
+
+        int start1, size1, start2, size2;
+        m_historyFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 > 0)
+            m_history[start1] = { Time::getMillisecondCounter(), tracker.getRoll(), tracker.getPitch(), tracker.getYaw() };
+        m_historyFifo.finishedWrite(size1);
     }
 }
 
 void Bridge::resetOrientation()
 {
-	qbW = qlW;
-	qbX = qlX;
-	qbY = qlY;
-	qbZ = qlZ;
+    const ScopedLock sl(m_trackerLock);
+    for (auto* tracker : m_trackers)
+        tracker->resetOrientation();
+}
+
+void Bridge::resetOrientation(int trackerId)
+{
+    // every input feeding the id starts over from its own reference
+    const ScopedLock sl(m_trackerLock);
+    for (auto* tracker : m_trackers)
+        if (tracker->getId() == trackerId)
+            tracker->resetOrientation();
+}
+
+void Bridge::setResetTransition(double transitionSeconds, double averagingSeconds)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_resetTransitionSeconds = transitionSeconds;
+    m_resetAveragingSeconds = averagingSeconds;
+    for (auto* tracker : m_trackers)
+        tracker->setResetTransition(transitionSeconds, averagingSeconds);
 }
 
-void Bridge::updateEuler()
+void Bridge::setCompassFusion(bool enabled, double timeConstantSeconds)
 {
-	const Array<float> quats = { qW, qX, qY, qZ };
+    const ScopedLock sl(m_trackerLock);
+    m_trackers[0]->getCompass().setEnabled(enabled);
+    m_trackers[0]->getCompass().setTimeConstant(timeConstantSeconds);
+}
 
-	qW = quats[0];
-	qX = quats[2];
-	qY = quats[1];
-	qZ = quats[3];
+void Bridge::setCompassCalibration(const String& calibration)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_trackers[0]->getCompass().setCalibration(CompassFusion::Calibration::fromString(calibration));
+}
 
-	// thanks to Charles Verron (https://www.noisemakers.fr/) for providing the code snippet used below
+void Bridge::startCompassCalibration()
+{
+    const ScopedLock sl(m_trackerLock);
+    m_trackers[0]->getCompass().startCalibration();
+}
 
-	double test = qX * qZ + qY * qW;
-	if (test > 0.499999)
-	{
-		// singularity at north pole
-		m_yaw = 2 * atan2(qX, qW);
-		m_pitch = MathConstants<double>::pi / 2;
-		m_roll = 0;
-		return;
-	}
-	if (test < -0.499999)
-	{
-		// singularity at south pole
-		m_yaw = -2 * atan2(qX, qW);
-		m_pitch = -MathConstants<double>::pi / 2;
-		m_roll = 0;
-		return;
-	}
-	double sqx = qX * qX;
-	double sqy = qZ * qZ;
-	double sqz = qY * qY;
+String Bridge::finishCompassCalibration()
+{
+    const ScopedLock sl(m_trackerLock);
+    auto& compass = m_trackers[0]->getCompass();
+    return compass.finishCalibration() ? compass.getCalibration().toString() : String();
+}
 
-	m_yaw = atan2(2 * qZ*qW - 2 * qX*qY, 1 - 2 * sqy - 2 * sqz);
-	m_pitch = asin(2 * test);
-	m_roll = atan2(2 * qX*qW - 2 * qZ*qY, 1 - 2 * sqx - 2 * sqz);
+bool Bridge::setDeviceRate(int hz)
+{
+    return sendDeviceCommand('F', { hz });
+}
 
-    m_yaw *= -1.0f;
+bool Bridge::setDeviceFilter(int hz)
+{
+    return sendDeviceCommand('L', { hz });
+}
 
-	m_yaw = radiansToDegrees(m_yaw);
-	m_pitch = radiansToDegrees(m_pitch);
-	m_roll = radiansToDegrees(m_roll);
+bool Bridge::setDeviceFeatures(int features)
+{
+    return sendDeviceCommand('D', { features });
 }
 
+bool Bridge::setDeviceFrameHold(int milliseconds)
+{
+    return sendDeviceCommand('H', { milliseconds });
+}
+
+bool Bridge::setDeviceBiases(const Array<int>& gyroAndAccel)
+{
+    jassert(gyroAndAccel.size() == 6);
+    return sendDeviceCommand('B', gyroAndAccel);
+}
+
+bool Bridge::requestDeviceConfig()
+{
+    return sendDeviceCommand('?', {});
+}
+
+Tracker::DeviceConfig Bridge::getDeviceConfig()
+{
+    const ScopedLock sl(m_trackerLock);
+    return m_trackers[0]->getDeviceConfig();
+}
+
+bool Bridge::runDeviceSelfTest()
+{
+    return sendDeviceCommand('S', {});
+}
+
+Tracker::SelfTestResult Bridge::getSelfTestResult()
+{
+    const ScopedLock sl(m_trackerLock);
+    return m_trackers[0]->getSelfTestResult();
+}
+
+Tracker::Telemetry Bridge::getTelemetry()
+{
+    const ScopedLock sl(m_trackerLock);
+    return m_trackers[0]->getTelemetry();
+}
+
+bool Bridge::sendDeviceCommand(char tag, const Array<int>& args)
+{
+    const ScopedLock sl(m_trackerLock);
+    return m_trackers[0]->sendCommand(tag, args);
+}
+
+bool Bridge::connectControlReceiver(int portNumber)
+{
+    disconnectControlReceiver();
+    return portNumber > 0 && m_controlReceiver.connect(portNumber);
+}
+
+void Bridge::disconnectControlReceiver()
+{
+    m_controlReceiver.disconnect();
+}
+
+void Bridge::oscMessageReceived(const OSCMessage& message)
+{
+    if (message.getAddressPattern().toString() == "/bridge/selftest")
+    {
+        runDeviceSelfTest();
+        return;
+    }
+
+    if (message.getAddressPattern().toString() != "/bridge/reset")
+        return;
+
+    if (message.isEmpty())
+        resetOrientation();
+    else if (message[0].isInt32())
+        resetOrientation(message[0].getInt32());
+}
+
+void Bridge::setDriftCompensation(const DriftCompensator::Settings& settings)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_driftSettings = settings;
+    for (auto* tracker : m_trackers)
+        tracker->setDriftCompensation(settings);
+}
+
+DriftCompensator::Settings Bridge::getDriftCompensation()
+{
+    const ScopedLock sl(m_trackerLock);
+    return m_driftSettings;
+}
 
 float Bridge::getRoll()
 {
-    return m_roll;
+    return m_activeSource->getRoll();
 }
 
 float Bridge::getPitch()
 {
-    return m_pitch;
+    return m_activeSource->getPitch();
 }
 
 float Bridge::getYaw()
 {
-    return m_yaw;
+    return m_activeSource->getYaw();
+}
+
+int Bridge::readOrientationHistory(OrientationSample* destination, int maxSamples)
+{
+    int start1, size1, start2, size2;
+    m_historyFifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        destination[i] = m_history[start1 + i];
+    for (int i = 0; i < size2; ++i)
+        destination[size1 + i] = m_history[start2 + i];
+
+    m_historyFifo.finishedRead(size1 + size2);
+    return size1 + size2;
 }
 
 float Bridge::getRollOSC()
@@ -256,50 +529,75 @@ float Bridge::getYawOSC()
 
 void Bridge::setupQuatsOSC(bool isActive, String address, Array<int> order, Array<int> signs)
 {
+    const ScopedLock sl(m_trackerLock);
     m_quatsActive = isActive;
     m_quatsOscAddress = address;
     m_quatsOrder = order;
     m_quatsSigns = signs;
+    updateOutputs();
 }
 
 void Bridge::setupRollOSC(bool isActive, String address, float min, float max)
 {
+    const ScopedLock sl(m_trackerLock);
     m_rollActive = isActive;
     m_rollOscAddress = address;
     m_rollOscMin = min;
     m_rollOscMax = max;
+    updateOutputs();
 }
 
 void Bridge::setupPitchOSC(bool isActive, String address, float min, float max)
 {
+    const ScopedLock sl(m_trackerLock);
     m_pitchActive = isActive;
     m_pitchOscAddress = address;
     m_pitchOscMin = min;
     m_pitchOscMax = max;
+    updateOutputs();
 }
 
 void Bridge::setupYawOSC(bool isActive, String address, float min, float max)
 {
+    const ScopedLock sl(m_trackerLock);
     m_yawActive = isActive;
     m_yawOscAddress = address;
     m_yawOscMin = min;
     m_yawOscMax = max;
+    updateOutputs();
 }
 
 void Bridge::setupRpyOSC(bool isActive, String address, String key)
 {
+    const ScopedLock sl(m_trackerLock);
     m_rpyActive = isActive;
     m_rpyOscAddress = address;
-    m_rpyOscKey = key;
+
+    // key like "ypr" gives the order of the sent values
+    for (int i = 0; i < 3; ++i)
+        m_rpyOrder[i] = key.length() == 3 ? String("rpy").indexOfChar(key[i]) : -1;
+    if (m_rpyOrder[1] < 0 || m_rpyOrder[2] < 0)
+        m_rpyOrder[0] = -1;
+
+    updateOutputs();
+}
+
+void Bridge::setupTelemetryOSC(bool isActive, String address)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_telemetryActive = isActive && address.isNotEmpty();
+    m_telemetryOscAddress = address;
+    updateOutputs();
 }
 
 void Bridge::setupIp(String address, int port)
 {
-    if (m_ipAddress != address || m_oscPortNumber != port)
-    {
-        m_ipAddress = address;
-        m_oscPortNumber = port;
-        sender.disconnect();
-        sender.connect(m_ipAddress, m_oscPortNumber);
-    }
+    const ScopedLock sl(m_trackerLock);
+    m_router.setDefaultDestination(address, port);
+}
+
+void Bridge::setupRoutes(String rules)
+{
+    const ScopedLock sl(m_trackerLock);
+    m_router.setRoutes(rules);
 }
@@ -25,28 +25,77 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "rs232.h"
+#include "Tracker.h"
+#include "OscRouting.h"
+#include "OscInput.h"
 
 class Bridge	: private Timer
-				, private OSCReceiver
-				, private OSCReceiver::Listener<OSCReceiver::RealtimeCallback>
+				, private Tracker::Listener
+				, private OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>
 {
 public:
+	struct OrientationSample
+	{
+		uint32 timeMs;
+		float roll, pitch, yaw;
+	};
+
     Bridge();    
     ~Bridge();
-	bool connectOscReceiver();
+	bool connectOscReceiver(int portNumber, const String& address);
 	void disconnectOscReceiver();
+	bool isOscReceiverConnected();
 
-	void oscMessageReceived(const OSCMessage& message) override;
-	void oscBundleReceived(const OSCBundle& bundle) override;
+	// inputs feeding the same tracker id are merged, the freshest one with the highest priority wins
+	bool addOscInput(int portNumber, const String& address, int trackerId, int priority);
+	void setInputPriorities(int serialPriority, int oscPriority);
+	void setStaleTimeout(int microseconds);
     
 	StringArray getPortInfo();
     bool connectSerial();
     void disconnectSerial();
 	bool isSerialConnected();
+	bool isReconnecting();
+	void setAutoReconnect(bool shouldReconnect);
 	void timerCallback() override;
-	void pushQuaternionVector();
 	void resetOrientation();
-	void updateEuler();
+	void resetOrientation(int trackerId);
+	void setResetTransition(double transitionSeconds, double averagingSeconds);
+
+	// 9-axis heading for the primary tracker, calibrations are strings for the settings file
+	void setCompassFusion(bool enabled, double timeConstantSeconds);
+	void setCompassCalibration(const String& calibration);
+	void startCompassCalibration();
+	String finishCompassCalibration(); // empty if the sweep wasn't usable
+
+	// runtime configuration of the primary tracker's firmware, getDeviceConfig()
+	// has what the device reported last
+	bool setDeviceRate(int hz);
+	bool setDeviceFilter(int hz);
+	bool setDeviceFeatures(int features); // Tracker::DeviceFeatures flags
+	bool setDeviceFrameHold(int milliseconds);
+	bool setDeviceBiases(const Array<int>& gyroAndAccel); // 6 values in q16
+	bool requestDeviceConfig();
+	Tracker::DeviceConfig getDeviceConfig();
+
+	// self-test and bias calibration, the tracker has to lie still and flat
+	bool runDeviceSelfTest();
+	Tracker::SelfTestResult getSelfTestResult();
+
+	// health reports of the primary tracker's firmware, see Tracker::Telemetry
+	Tracker::Telemetry getTelemetry();
+
+	// remote control, "/bridge/reset" resets all trackers, "/bridge/reset <id>" a single one,
+	// "/bridge/selftest" runs the self-test of the primary tracker
+	bool connectControlReceiver(int portNumber);
+	void disconnectControlReceiver();
+	void setDriftCompensation(const DriftCompensator::Settings& settings);
+	DriftCompensator::Settings getDriftCompensation();
+
+	// additional trackers, see OscAddressTemplate for their output addresses
+	int addTracker(const String& portName);
+	void removeTracker(int trackerId);
+	int getNumTrackers();
 
 	float getRoll();
 	float getPitch();
@@ -55,37 +104,69 @@ public:
 	float getPitchOSC();
 	float getYawOSC();
 
+	// recent samples of the primary tracker, for the GUI thread only
+	int readOrientationHistory(OrientationSample* destination, int maxSamples);
+
 	void setupQuatsOSC(bool isActive, String address, Array<int> order, Array<int> signs);
 	void setupRollOSC(bool isActive, String address, float min, float max);
 	void setupPitchOSC(bool isActive, String address, float min, float max);
 	void setupYawOSC(bool isActive, String address, float min, float max);
 	void setupRpyOSC(bool isActive, String address, String key);
+	void setupTelemetryOSC(bool isActive, String address);
 	void setupIp(String address, int port);
+	void setupRoutes(String rules);
 
 	int BaudR = 115200, PortN;
 private:
-	StringPairArray portlist;
-
-	int port_number, port_index, port_state;
+	void trackerOrientationChanged(Tracker& tracker) override;
+	void trackerRescanPorts() override;
+	void trackerResetRequested(Tracker& tracker) override;
+	void trackerTelemetryReceived(Tracker& tracker) override;
+	void oscMessageReceived(const OSCMessage& message) override;
+	bool isPortClaimed(const String& portName, const Tracker* except) override;
+	void updateTimer();
+	void updateOutputs();
+	bool isOscInputTracker(const Tracker* tracker);
+	bool isSelectedSource(Tracker& tracker);
+	Tracker* createTracker(int trackerId);
+	bool sendDeviceCommand(char tag, const Array<int>& args);
 
-	double qW = 1.0, qX = 0.0, qY = 0.0, qZ = 0.0;
-	double qlW = 1.0, qlX = 0.0, qlY = 0.0, qlZ = 0.0;
-	double qbW = 1.0, qbX = 0.0, qbY = 0.0, qbZ = 0.0;
+	StringPairArray portlist;
 
-	float m_roll = 0.0, m_pitch = 0.0, m_yaw = 0.0;
-	bool m_quatsActive, m_rollActive, m_pitchActive, m_yawActive, m_rpyActive;
+	int port_number, port_index;
+
+	CriticalSection m_trackerLock;
+	OwnedArray<Tracker> m_trackers; // the first one is the primary tracker driven by the GUI
+	OwnedArray<OscInput> m_oscInputs; // the first one is the OSC input driven by the GUI
+	Tracker* m_activeSource;
+	int m_nextTrackerId = 1;
+	int64 m_staleTicks;
+	DriftCompensator::Settings m_driftSettings;
+	double m_resetTransitionSeconds = 0.0, m_resetAveragingSeconds = 0.0;
+	OSCReceiver m_controlReceiver;
+
+	// pre-encoded output messages, one set per tracker
+	struct TrackerOutput
+	{
+		OscFloatMessage quats, roll, pitch, yaw, rpy, telemetry;
+	};
+	OwnedArray<TrackerOutput> m_outputs;
+	OscRouter m_router;
+
+	bool m_quatsActive, m_rollActive, m_pitchActive, m_yawActive, m_rpyActive, m_telemetryActive = false;
 	String m_quatsOscAddress;
 	Array<int> m_quatsOrder, m_quatsSigns;
 	String m_rollOscAddress, m_pitchOscAddress, m_yawOscAddress;
 	float m_rollOscMin, m_pitchOscMin, m_yawOscMin;
 	float m_rollOscMax, m_pitchOscMax, m_yawOscMax;
-	String m_rpyOscAddress, m_rpyOscKey;
+	String m_rpyOscAddress;
+	int m_rpyOrder[3] = { -1, -1, -1 };
+	String m_telemetryOscAddress;
 	float m_rollOSC = 0.0, m_pitchOSC = 0.0, m_yawOSC = 0.0;
 
-	bool m_serialPortConnected = false;
-	String m_ipAddress;
-	int m_oscPortNumber;
-	OSCSender sender;
+	// single writer (the tracker thread), single reader (the GUI), samples are dropped when it's full
+	AbstractFifo m_historyFifo { 1024 };
+	OrientationSample m_history[1024];
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Bridge)
-};        
+};
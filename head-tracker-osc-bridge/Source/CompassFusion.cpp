@@ -0,0 +1,190 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CompassFusion.h"
+
+static double wrapAngle(double radians)
+{
+	return remainder(radians, MathConstants<double>::twoPi);
+}
+
+String CompassFusion::Calibration::toString() const
+{
+	StringArray values;
+	for (int i = 0; i < 3; ++i)
+		values.add(String(offset[i]));
+	for (int i = 0; i < 3; ++i)
+		values.add(String(scale[i]));
+	values.add(String(fieldStrength));
+	return values.joinIntoString(",");
+}
+
+CompassFusion::Calibration CompassFusion::Calibration::fromString(const String& text)
+{
+	// "offsetX,offsetY,offsetZ,scaleX,scaleY,scaleZ,fieldStrength"
+	Calibration calibration;
+	StringArray values = StringArray::fromTokens(text, ",", "");
+	if (values.size() != 7)
+		return calibration;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		calibration.offset[i] = values[i].getDoubleValue();
+		calibration.scale[i] = values[i + 3].getDoubleValue();
+	}
+	calibration.fieldStrength = values[6].getDoubleValue();
+	return calibration;
+}
+
+void CompassFusion::setEnabled(bool shouldBeEnabled)
+{
+	m_enabled = shouldBeEnabled;
+}
+
+void CompassFusion::setTimeConstant(double seconds)
+{
+	m_timeConstant = jmax(0.1, seconds);
+}
+
+void CompassFusion::setCalibration(const Calibration& calibration)
+{
+	m_calibration = calibration;
+}
+
+void CompassFusion::startCalibration()
+{
+	m_calibrating = true;
+	m_numCalibrationSamples = 0;
+}
+
+bool CompassFusion::finishCalibration()
+{
+	m_calibrating = false;
+
+	if (m_numCalibrationSamples < 50)
+		return false;
+
+	Calibration calibration;
+	double radius[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		calibration.offset[i] = (m_maximum[i] + m_minimum[i]) / 2;
+		radius[i] = (m_maximum[i] - m_minimum[i]) / 2;
+		if (radius[i] <= 0.0)
+			return false;
+	}
+
+	// scale the ellipsoid axes to the mean radius
+	calibration.fieldStrength = (radius[0] + radius[1] + radius[2]) / 3;
+	for (int i = 0; i < 3; ++i)
+	{
+		// a sweep that barely turned around an axis isn't usable
+		if (radius[i] < 0.5 * calibration.fieldStrength)
+			return false;
+		calibration.scale[i] = calibration.fieldStrength / radius[i];
+	}
+
+	m_calibration = calibration;
+	return true;
+}
+
+void CompassFusion::addMeasurement(double x, double y, double z)
+{
+	const double field[3] = { x, y, z };
+
+	if (m_calibrating)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			m_minimum[i] = m_numCalibrationSamples == 0 ? field[i] : jmin(m_minimum[i], field[i]);
+			m_maximum[i] = m_numCalibrationSamples == 0 ? field[i] : jmax(m_maximum[i], field[i]);
+		}
+		++m_numCalibrationSamples;
+		return;
+	}
+
+	for (int i = 0; i < 3; ++i)
+		m_field[i] = (field[i] - m_calibration.offset[i]) * m_calibration.scale[i];
+	m_newMeasurement = true;
+}
+
+void CompassFusion::process(double& w, double& x, double& y, double& z)
+{
+	if (!m_enabled || m_calibrating || !m_calibration.isValid())
+		return;
+
+	if (m_newMeasurement)
+	{
+		m_newMeasurement = false;
+		updateHeading(w, x, y, z);
+	}
+
+	if (!m_hasHeading)
+		return;
+
+	// rotation about the vertical axis by -correction, applied in the world frame
+	const double c = cos(m_headingCorrection / 2), s = -sin(m_headingCorrection / 2);
+	const double qw = w, qx = x, qy = y, qz = z;
+	w = c * qw - s * qz;
+	x = c * qx - s * qy;
+	y = c * qy + s * qx;
+	z = c * qz + s * qw;
+}
+
+void CompassFusion::updateHeading(double w, double x, double y, double z)
+{
+	const double* m = m_field;
+	const double strength = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+
+	// magnets and steel nearby change the field strength, such samples are ignored
+	if (std::abs(strength - m_calibration.fieldStrength) > 0.3 * m_calibration.fieldStrength)
+		return;
+
+	// v' = q v q*, written as v + 2w (u x v) + 2 u x (u x v)
+	const double tx = 2 * (y * m[2] - z * m[1]);
+	const double ty = 2 * (z * m[0] - x * m[2]);
+	const double tz = 2 * (x * m[1] - y * m[0]);
+	const double worldX = m[0] + w * tx + (y * tz - z * ty);
+	const double worldY = m[1] + w * ty + (z * tx - x * tz);
+
+	// close to the magnetic poles the horizontal component is too small to tell the heading
+	if (worldX * worldX + worldY * worldY < 0.01 * strength * strength)
+		return;
+
+	const double heading = atan2(worldY, worldX);
+	const int64 ticks = Time::getHighResolutionTicks();
+
+	if (!m_hasHeading)
+	{
+		m_headingCorrection = heading;
+		m_hasHeading = true;
+	}
+	else
+	{
+		const double seconds = jmin(1.0, Time::highResolutionTicksToSeconds(ticks - m_lastHeadingTicks));
+		m_headingCorrection = wrapAngle(m_headingCorrection
+			+ wrapAngle(heading - m_headingCorrection) * seconds / (m_timeConstant + seconds));
+	}
+
+	m_lastHeadingTicks = ticks;
+}
@@ -0,0 +1,83 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+	Complementary heading correction for trackers that send magnetometer
+	frames next to the 6-axis quaternion. The calibrated field is rotated
+	into the world frame with the raw orientation, its horizontal direction
+	gives the heading, and the quaternion is slowly turned about the
+	vertical axis so the heading follows the compass instead of the gyro.
+	Tilt stays with the sensor's own fusion.
+*/
+class CompassFusion
+{
+public:
+	// hard-iron offset and soft-iron scale per axis, fitted to the min/max of a calibration sweep
+	struct Calibration
+	{
+		double offset[3] = { 0.0, 0.0, 0.0 };
+		double scale[3] = { 1.0, 1.0, 1.0 };
+		double fieldStrength = 0.0; // 0 if not calibrated
+
+		bool isValid() const { return fieldStrength > 0.0; }
+		String toString() const;
+		static Calibration fromString(const String& text);
+	};
+
+	void setEnabled(bool shouldBeEnabled);
+	void setTimeConstant(double seconds);
+	void setCalibration(const Calibration& calibration);
+	const Calibration& getCalibration() const { return m_calibration; }
+
+	// rotate the tracker in all directions between start and finish
+	void startCalibration();
+	bool finishCalibration(); // false if the sweep didn't cover enough
+	bool isCalibrating() const { return m_calibrating; }
+
+	void addMeasurement(double x, double y, double z);
+
+	// turns the normalised raw quaternion to the compass heading
+	void process(double& w, double& x, double& y, double& z);
+
+private:
+	void updateHeading(double w, double x, double y, double z);
+
+	Calibration m_calibration;
+	bool m_enabled = false;
+	double m_timeConstant = 5.0;
+
+	bool m_calibrating = false;
+	double m_minimum[3], m_maximum[3];
+	int m_numCalibrationSamples = 0;
+
+	double m_field[3] = { 0.0, 0.0, 0.0 };
+	bool m_newMeasurement = false;
+
+	double m_headingCorrection = 0.0; // radians
+	bool m_hasHeading = false;
+	int64 m_lastHeadingTicks = 0;
+};
@@ -0,0 +1,86 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DriftCompensator.h"
+
+void DriftCompensator::setSettings(const Settings& settings)
+{
+	m_settings = settings;
+	if (!m_settings.enabled)
+		reset();
+}
+
+void DriftCompensator::reset()
+{
+	m_hasPrevious = false;
+	m_stillTime = 0.0;
+	m_driftRate = 0.0;
+}
+
+double DriftCompensator::process(double w, double x, double y, double z, double seconds)
+{
+	if (!m_settings.enabled)
+		return 0.0;
+
+	const double pw = m_previous[0], px = m_previous[1], py = m_previous[2], pz = m_previous[3];
+	const bool hasPrevious = m_hasPrevious;
+
+	m_previous[0] = w;
+	m_previous[1] = x;
+	m_previous[2] = y;
+	m_previous[3] = z;
+	m_hasPrevious = true;
+
+	// the first sample and gaps in the stream don't tell anything about the rate
+	if (!hasPrevious || seconds <= 0.0 || seconds > 0.5)
+	{
+		m_stillTime = 0.0;
+		return 0.0;
+	}
+
+	// rotation since the previous sample in the world frame: q * conj(p)
+	double dw = w * pw + x * px + y * py + z * pz;
+	double dx = -w * px + x * pw - y * pz + z * py;
+	double dy = -w * py + x * pz + y * pw - z * px;
+	double dz = -w * pz - x * py + y * px + z * pw;
+	if (dw < 0.0)
+	{
+		dw = -dw; dx = -dx; dy = -dy; dz = -dz;
+	}
+
+	const double angle = 2.0 * atan2(sqrt(dx * dx + dy * dy + dz * dz), dw);
+	if (radiansToDegrees(angle / seconds) < m_settings.stationaryRate)
+		m_stillTime += seconds;
+	else
+		m_stillTime = 0.0;
+
+	// while the head is still any yaw change is drift
+	if (isStationary())
+	{
+		const double yawRate = 2.0 * atan2(dz, dw) / seconds;
+		m_driftRate += (yawRate - m_driftRate) * seconds / (m_driftTimeConstant + seconds);
+	}
+
+	const double maxCorrection = degreesToRadians(m_settings.maxCorrectionRate) * seconds;
+	return jlimit(-maxCorrection, maxCorrection, m_driftRate * seconds);
+}
@@ -0,0 +1,63 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+	Estimates the slow yaw drift of the raw sensor orientation while the
+	head is still and hands back the small correction the rebase has to
+	turn by, so the output stays put without pressing reset. Rotations
+	are about the vertical (Z) axis of the sensor's world frame.
+*/
+class DriftCompensator
+{
+public:
+	struct Settings
+	{
+		bool enabled = false;
+		double stationaryRate = 2.0; // deg/s, slower turns count as standing still
+		double stationaryTime = 1.0; // s the head has to stay still before drift is measured
+		double maxCorrectionRate = 0.5; // deg/s, limits how fast the rebase is turned
+	};
+
+	void setSettings(const Settings& settings);
+	const Settings& getSettings() const { return m_settings; }
+	void reset();
+
+	// takes the normalised raw quaternion, returns the yaw correction in radians
+	double process(double w, double x, double y, double z, double seconds);
+
+	double getDriftRate() const { return radiansToDegrees(m_driftRate); } // deg/s
+	bool isStationary() const { return m_stillTime >= m_settings.stationaryTime; }
+
+private:
+	Settings m_settings;
+
+	bool m_hasPrevious = false;
+	double m_previous[4] = { 1.0, 0.0, 0.0, 0.0 };
+	double m_stillTime = 0.0;
+	double m_driftRate = 0.0; // rad/s, low-passed over the stationary periods
+	const double m_driftTimeConstant = 10.0; // s
+};
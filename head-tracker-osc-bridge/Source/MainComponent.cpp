@@ -59,6 +59,27 @@ MainComponent::MainComponent()
 	m_resetButton.addListener(this);
 	addAndMakeVisible(m_resetButton);
 
+	m_driftButton.setButtonText("Auto Re-centre");
+	m_driftButton.setClickingTogglesState(true);
+	m_driftButton.onClick = [this] { updateDriftCompensation(); saveSettings(); };
+	m_driftButton.setColour(TextButton::buttonColourId, clblue);
+	m_driftButton.setColour(TextButton::buttonOnColourId, cgrnsh);
+	m_driftButton.setLookAndFeel(&SMLF);
+	addAndMakeVisible(m_driftButton);
+
+	m_compassButton.setButtonText("Compass");
+	m_compassButton.setColour(TextButton::buttonColourId, clblue);
+	m_compassButton.setColour(TextButton::buttonOnColourId, cgrnsh);
+	m_compassButton.setLookAndFeel(&SMLF);
+	m_compassButton.addListener(this);
+	addAndMakeVisible(m_compassButton);
+
+	m_selfTestButton.setButtonText("Self-test");
+	m_selfTestButton.setColour(TextButton::buttonColourId, clblue);
+	m_selfTestButton.setLookAndFeel(&SMLF);
+	m_selfTestButton.addListener(this);
+	addAndMakeVisible(m_selfTestButton);
+
 	m_quatsOscActive.setButtonText("Q");
 	m_quatsOscActive.setClickingTogglesState(true);
 	m_quatsOscActive.onStateChange = [this] { updateBridgeSettings(); };
@@ -136,22 +157,24 @@ MainComponent::MainComponent()
 	}
 	addAndMakeVisible(m_oscPresetCB);
 
-	// labels
-	Array<Label*> rpyValLabels;
-	rpyValLabels.add(&m_rollLabel);
-	rpyValLabels.add(&m_pitchLabel);
-	rpyValLabels.add(&m_yawLabel);
-	rpyValLabels.add(&m_rollOscVal);
-	rpyValLabels.add(&m_pitchOscVal);
-	rpyValLabels.add(&m_yawOscVal);
+	// readouts
+	m_orientationReadout.setFont(labelfont.withPointHeight(13));
+	m_orientationReadout.setColour(clrblue);
+	m_orientationReadout.setRowHeight(20);
+	addAndMakeVisible(m_orientationReadout);
 
-	for (int i = 0; i < rpyValLabels.size(); ++i)
-	{
-		rpyValLabels[i]->setFont(labelfont.withPointHeight(13));
-		rpyValLabels[i]->setJustificationType(Justification::centredRight);
-		rpyValLabels[i]->setColour(Label::textColourId, clrblue);
-		addAndMakeVisible(rpyValLabels[i]);
-	}
+	m_oscValueReadout.setFont(labelfont.withPointHeight(13));
+	m_oscValueReadout.setColour(clrblue);
+	m_oscValueReadout.setRowHeight(30);
+	addAndMakeVisible(m_oscValueReadout);
+
+	m_tracePlot.setBackgroundColour(cdark.brighter(0.1f));
+	m_tracePlot.setChannel(0, "roll", cred.withSaturation(0.6f));
+	m_tracePlot.setChannel(1, "pitch", cgrnsh);
+	m_tracePlot.setChannel(2, "yaw", clblue);
+	addAndMakeVisible(m_tracePlot);
+
+	// labels
 
 	Array<Label*> oscLabels;
 	oscLabels.add(&m_quatsOscAddress);
@@ -182,12 +205,30 @@ MainComponent::MainComponent()
 		addAndMakeVisible(oscLabels[i]);
 	}
 
+	Array<Label*> oscInputLabels;
+	oscInputLabels.add(&m_oscInputPort);
+	oscInputLabels.add(&m_oscInputAddress);
+
+	for (int i = 0; i < oscInputLabels.size(); ++i)
+	{
+		oscInputLabels[i]->setEditable(false, true, false);
+		oscInputLabels[i]->onTextChange = [this] { switchInput(); };
+		oscInputLabels[i]->setLookAndFeel(&SMLF);
+		oscInputLabels[i]->setColour(Label::textColourId, cdark);
+		oscInputLabels[i]->setColour(Label::backgroundColourId, clrblue);
+		oscInputLabels[i]->setFont(labelfont.withPointHeight(13));
+		oscInputLabels[i]->setJustificationType(Justification::centred);
+		addChildComponent(oscInputLabels[i]);
+	}
+	m_oscInputPort.setText("8888", dontSendNotification);
+	m_oscInputAddress.setText("/bridge/quat", dontSendNotification);
+
 	// 3d head
 	addAndMakeVisible(m_binauralHeadView);
 
 	loadSettings();
-	startTimerHz(20);
-	setSize(300, 650);
+	switchInput();
+	setSize(300, 840);
 }
 
 MainComponent::~MainComponent()
@@ -211,8 +252,8 @@ void MainComponent::paint (Graphics& g)
 
 	// labels
 	Rectangle<float> serialLabelArea(10, 40, 280, 50);
-	Rectangle<float> imuLabelArea(10, 220, 280, 50);
-	Rectangle<float> oscLabelArea(10, 350, 280, 50);
+	Rectangle<float> imuLabelArea(10, 300, 280, 50);
+	Rectangle<float> oscLabelArea(10, 520, 280, 50);
 
 	g.setColour(clrblue);
 	g.fillRoundedRectangle(serialLabelArea, 3.0f);
@@ -236,14 +277,23 @@ void MainComponent::paint (Graphics& g)
 	}
 	if (m_oscInputButton.getToggleState())
 	{
-		g.drawText("Receiving port: 8888", 10, 140, 280, 30, Justification::centred);
-		g.drawText("OSC address: /bridge/quat", 10, 170, 280, 30, Justification::centred);
+		g.drawText("OSC In:", 10, 260, 60, 30, Justification::centredLeft);
 	}
 
 	g.setFont(titlefontB.withPointHeight(13));
-	g.drawText("Roll (Y):", 20, 280, 125, 20, Justification::centredLeft);
-	g.drawText("Pitch (X):", 20, 300, 125, 20, Justification::centredLeft);
-	g.drawText("Yaw (Z):", 20, 320, 125, 20, Justification::centredLeft);
+	g.drawText("Roll (Y):", 20, 360, 125, 20, Justification::centredLeft);
+	g.drawText("Pitch (X):", 20, 380, 125, 20, Justification::centredLeft);
+	g.drawText("Yaw (Z):", 20, 400, 125, 20, Justification::centredLeft);
+
+	// firmware health above the footer, red if the last report counted errors
+	if (m_telemetry.sequence > 0)
+	{
+		g.setFont(titlefontB.withPointHeight(12));
+		g.setColour(m_telemetry.getNumErrors() > 0 ? cred : clrblue);
+		g.drawText(String(m_telemetry.temperature, 1) + " C, loop " + String(m_telemetry.maxLoopMicros) + " us, "
+			+ String(m_telemetry.freeRam) + " B free, " + String(m_telemetry.getNumErrors()) + " errors",
+			getTelemetryArea(), Justification::centredLeft);
+	}
 
 	// version number & authors
 	g.setFont(titlefontB.withPointHeight(12));
@@ -254,20 +304,25 @@ void MainComponent::paint (Graphics& g)
 
 void MainComponent::resized()
 {
-	int shift = 40;
+	int shift = 120;
 	m_serialInputButton.setBounds(10, 100, 135, 30);
 	m_oscInputButton.setBounds(155, 100, 135, 30);
-	m_refreshButton.setBounds(10, 100 + shift, 135, 30);
-	m_connectButton.setBounds(155, 100 + shift, 135, 30);
-	m_portListCB.setBounds(155, 140 + shift, 135, 30);
-	m_resetButton.setBounds(155, 240 + shift, 135, 60);
-
-	m_rollLabel.setBounds(70, 240 + shift, 65, 20);
-	m_pitchLabel.setBounds(70, 260 + shift, 65, 20);
-	m_yawLabel.setBounds(70, 280 + shift, 65, 20);
+	m_refreshButton.setBounds(10, 140, 135, 30);
+	m_connectButton.setBounds(155, 140, 135, 30);
+	m_portListCB.setBounds(155, 180, 135, 30);
+	m_selfTestButton.setBounds(155, 220, 135, 30);
+	m_oscInputPort.setBounds(70, 260, 75, 30);
+	m_oscInputAddress.setBounds(155, 260, 135, 30);
+	m_resetButton.setBounds(155, 240 + shift, 65, 30);
+	m_compassButton.setBounds(225, 240 + shift, 65, 30);
+	m_driftButton.setBounds(155, 275 + shift, 135, 25);
+
+	m_orientationReadout.setBounds(70, 240 + shift, 60, 60);
 
 	m_binauralHeadView.setBounds(220, 180 + shift, 50, 50);
+	m_tracePlot.setBounds(10, 310 + shift, 280, 80);
 
+	shift += 90;
 	m_quatsOscActive.setBounds(10, 370 + shift, 25, 25);
 	m_rollOscActive.setBounds(10, 400 + shift, 25, 25);
 	m_pitchOscActive.setBounds(10, 430 + shift, 25, 25);
@@ -280,15 +335,13 @@ void MainComponent::resized()
 	m_pitchOscAddress.setBounds(40, 430 + shift, 105, 25);
 	m_yawOscAddress.setBounds(40, 460 + shift, 105, 25);
 	m_rpyOscAddress.setBounds(40, 490 + shift, 105, 25);
-	m_rollOscMin.setBounds(155, 400 + shift, 40, 25);
-	m_pitchOscMin.setBounds(155, 430 + shift, 40, 25);
-	m_yawOscMin.setBounds(155, 460 + shift, 40, 25);
-	m_rollOscMax.setBounds(200, 400 + shift, 40, 25);
-	m_pitchOscMax.setBounds(200, 430 + shift, 40, 25);
-	m_yawOscMax.setBounds(200, 460 + shift, 40, 25);
-	m_rollOscVal.setBounds(245, 400 + shift, 45, 25);
-	m_pitchOscVal.setBounds(245, 430 + shift, 45, 25);
-	m_yawOscVal.setBounds(245, 460 + shift, 45, 25);
+	m_rollOscMin.setBounds(155, 400 + shift, 37, 25);
+	m_pitchOscMin.setBounds(155, 430 + shift, 37, 25);
+	m_yawOscMin.setBounds(155, 460 + shift, 37, 25);
+	m_rollOscMax.setBounds(197, 400 + shift, 37, 25);
+	m_pitchOscMax.setBounds(197, 430 + shift, 37, 25);
+	m_yawOscMax.setBounds(197, 460 + shift, 37, 25);
+	m_oscValueReadout.setBounds(238, 400 + shift, 52, 85);
 	m_ipAddress.setBounds(10, 520 + shift, 135, 25);
 	m_portNumber.setBounds(155, 520 + shift, 135, 25);
 
@@ -298,16 +351,15 @@ void MainComponent::resized()
 
 void MainComponent::buttonClicked(Button* buttonThatWasClicked)
 {
+	// serial and OSC inputs can run side by side, the bridge picks the active source
 	if (buttonThatWasClicked == &m_serialInputButton)
 	{
-		m_serialInputButton.setToggleState(true, dontSendNotification);
-		m_oscInputButton.setToggleState(false, dontSendNotification);
+		m_serialInputButton.setToggleState(!m_serialInputButton.getToggleState(), dontSendNotification);
 		switchInput();
 	}
 	else if (buttonThatWasClicked == &m_oscInputButton)
 	{
-		m_serialInputButton.setToggleState(false, dontSendNotification);
-		m_oscInputButton.setToggleState(true, dontSendNotification);
+		m_oscInputButton.setToggleState(!m_oscInputButton.getToggleState(), dontSendNotification);
 		switchInput();
 	}
 	else if (buttonThatWasClicked == &m_refreshButton)
@@ -323,24 +375,51 @@ void MainComponent::buttonClicked(Button* buttonThatWasClicked)
 			m_connectButton.setButtonText("Connect");
 			m_refreshButton.setEnabled(true);
 			m_portListCB.setEnabled(true);
-			m_resetButton.setEnabled(false);
 		}
 		else
 		{
 			if (bridge.connectSerial())
 			{
+				configureDevice();
 				m_connectButton.setToggleState(true, dontSendNotification);
 				m_connectButton.setButtonText("Disconnect");
 				m_refreshButton.setEnabled(false);
 				m_portListCB.setEnabled(false);
-				m_resetButton.setEnabled(true);
 			}
 		}
+		updateResetButton();
 	}
 	else if (buttonThatWasClicked == &m_resetButton)
 	{
 		bridge.resetOrientation();
 	}
+	else if (buttonThatWasClicked == &m_selfTestButton)
+	{
+		// the result arrives as a tagged frame, see checkSelfTest()
+		if (!bridge.runDeviceSelfTest())
+			AlertWindow::showMessageBoxAsync(AlertWindow::NoIcon, "Self-test", "The tracker isn't connected.", "OK");
+	}
+	else if (buttonThatWasClicked == &m_compassButton)
+	{
+		// the calibration runs while the tracker is turned in all directions
+		if (!m_compassButton.getToggleState())
+		{
+			bridge.startCompassCalibration();
+			m_compassButton.setToggleState(true, dontSendNotification);
+			m_compassButton.setButtonText("Done");
+		}
+		else
+		{
+			const String calibration = bridge.finishCompassCalibration();
+			m_compassButton.setToggleState(false, dontSendNotification);
+			m_compassButton.setButtonText("Compass");
+
+			if (calibration.isEmpty())
+				AlertWindow::showMessageBoxAsync(AlertWindow::NoIcon, "Compass", "Calibration failed, turn the tracker slowly through all directions and try again.", "OK");
+			else
+				appSettings.getUserSettings()->setValue("compassCalibration", calibration);
+		}
+	}
 }
 
 void MainComponent::switchInput()
@@ -349,6 +428,7 @@ void MainComponent::switchInput()
 	m_refreshButton.setVisible(serialInput);
 	m_connectButton.setVisible(serialInput);
 	m_portListCB.setVisible(serialInput);
+	m_selfTestButton.setVisible(serialInput);
 	if (!serialInput)
 	{
 		bridge.disconnectSerial();
@@ -356,32 +436,146 @@ void MainComponent::switchInput()
 		m_connectButton.setButtonText("Connect");
 		m_refreshButton.setEnabled(true);
 		m_portListCB.setEnabled(true);
-		m_resetButton.setEnabled(false);
 	}
 
 	bool oscInput = m_oscInputButton.getToggleState();
+	m_oscInputPort.setVisible(oscInput);
+	m_oscInputAddress.setVisible(oscInput);
+	if (!m_oscInputAddress.getText().startsWithChar('/')) m_oscInputAddress.setText("/" + m_oscInputAddress.getText(), dontSendNotification);
 	if (oscInput)
 	{
-		bridge.connectOscReceiver();
-		m_resetButton.setEnabled(true);
+		if (!bridge.connectOscReceiver(m_oscInputPort.getText().getIntValue(), m_oscInputAddress.getText()))
+			AlertWindow::showMessageBoxAsync(AlertWindow::NoIcon, "OSC input", "Can't receive on port " + m_oscInputPort.getText(), "OK");
 	}
 	else
 	{
 		bridge.disconnectOscReceiver();
 	}
 
+	updateResetButton();
+	saveSettings();
 	repaint();
 }
 
+void MainComponent::updateResetButton()
+{
+	m_resetButton.setEnabled(bridge.isSerialConnected() || bridge.isOscReceiverConnected());
+	m_selfTestButton.setEnabled(bridge.isSerialConnected());
+}
+
+void MainComponent::updateDriftCompensation()
+{
+	// the thresholds are only tunable in the settings file
+	DriftCompensator::Settings drift;
+	drift.enabled = m_driftButton.getToggleState();
+	drift.stationaryRate = appSettings.getUserSettings()->getDoubleValue("driftStationaryRate", drift.stationaryRate);
+	drift.stationaryTime = appSettings.getUserSettings()->getDoubleValue("driftStationaryTime", drift.stationaryTime);
+	drift.maxCorrectionRate = appSettings.getUserSettings()->getDoubleValue("driftMaxCorrectionRate", drift.maxCorrectionRate);
+	bridge.setDriftCompensation(drift);
+}
+
+void MainComponent::configureDevice()
+{
+	// firmware parameters are only tunable in the settings file, unset ones keep the firmware defaults
+	auto* settings = appSettings.getUserSettings();
+	if (settings->containsKey("deviceRate"))
+		bridge.setDeviceRate(settings->getIntValue("deviceRate"));
+	if (settings->containsKey("deviceFilter"))
+		bridge.setDeviceFilter(settings->getIntValue("deviceFilter"));
+	if (settings->containsKey("deviceFeatures"))
+		bridge.setDeviceFeatures(settings->getIntValue("deviceFeatures"));
+	if (settings->containsKey("deviceFrameHold"))
+		bridge.setDeviceFrameHold(settings->getIntValue("deviceFrameHold"));
+}
+
+void MainComponent::checkSelfTest()
+{
+	const Tracker::SelfTestResult result = bridge.getSelfTestResult();
+	if (result.sequence == m_selfTestSequence)
+		return;
+
+	m_selfTestSequence = result.sequence;
+
+	// kept per device, boards can be screened and told apart later
+	const String deviceId = result.deviceId.isNotEmpty() ? result.deviceId : "unknown";
+	appSettings.getUserSettings()->setValue("selfTest." + deviceId, result.toString());
+
+	String message = "Device " + deviceId + "\n";
+	if (result.passed())
+	{
+		message << "Passed, the biases are saved on the tracker.";
+	}
+	else
+	{
+		message << "Failed:";
+		if (!(result.mask & 1)) message << " gyro";
+		if (!(result.mask & 2)) message << " accel";
+		if (!(result.mask & 4)) message << " compass";
+		if ((result.mask & 3) == 3) message << ", the biases are saved on the tracker.";
+	}
+	message << "\nGyro bias " << result.gyroBias[0] << ", " << result.gyroBias[1] << ", " << result.gyroBias[2]
+		<< "\nAccel bias " << result.accelBias[0] << ", " << result.accelBias[1] << ", " << result.accelBias[2];
+
+	AlertWindow::showMessageBoxAsync(AlertWindow::NoIcon, "Self-test", message, "OK");
+}
+
+Rectangle<int> MainComponent::getTelemetryArea() const
+{
+	return { 10, getHeight() - 50, 280, 20 };
+}
+
+void MainComponent::checkTelemetry()
+{
+	const Tracker::Telemetry telemetry = bridge.getTelemetry();
+	if (telemetry.sequence == m_telemetry.sequence)
+		return;
+
+	m_telemetry = telemetry;
+	repaint(getTelemetryArea());
+}
+
 void MainComponent::timerCallback()
 {
-    m_rollLabel.setText(String(bridge.getRoll(),1) + "°", dontSendNotification);
-    m_pitchLabel.setText(String(bridge.getPitch(),1) + "°", dontSendNotification);
-    m_yawLabel.setText(String(bridge.getYaw(),1) + "°", dontSendNotification);
-    m_rollOscVal.setText(String(bridge.getRollOSC(), 2), dontSendNotification);
-    m_pitchOscVal.setText(String(bridge.getPitchOSC(), 2), dontSendNotification);
-    m_yawOscVal.setText(String(bridge.getYawOSC(), 2), dontSendNotification);
-    m_binauralHeadView.setHeadOrientation(bridge.getRoll(), bridge.getPitch(), bridge.getYaw());
+	if (m_connectButton.getToggleState())
+		m_connectButton.setButtonText(bridge.isReconnecting() ? "Reconnecting..." : "Disconnect");
+
+	checkSelfTest();
+
+	// the GUI samples the bridge at its own rate, whatever the input rate is
+	if (m_performanceMode)
+		return;
+
+	m_orientationReadout.setValue(0, bridge.getRoll());
+	m_orientationReadout.setValue(1, bridge.getPitch());
+	m_orientationReadout.setValue(2, bridge.getYaw());
+	m_orientationReadout.flushChanges();
+
+	m_oscValueReadout.setValue(0, bridge.getRollOSC());
+	m_oscValueReadout.setValue(1, bridge.getPitchOSC());
+	m_oscValueReadout.setValue(2, bridge.getYawOSC());
+	m_oscValueReadout.flushChanges();
+
+	m_binauralHeadView.setHeadOrientation(bridge.getRoll(), bridge.getPitch(), bridge.getYaw());
+	checkTelemetry();
+
+	Bridge::OrientationSample samples[64];
+	int numSamples;
+	while ((numSamples = bridge.readOrientationHistory(samples, 64)) > 0)
+	{
+		for (int i = 0; i < numSamples; ++i)
+		{
+			const float values[3] = { samples[i].roll, samples[i].pitch, samples[i].yaw };
+			m_tracePlot.addSample(samples[i].timeMs, values);
+		}
+	}
+	m_tracePlot.advanceTo(Time::getMillisecondCounter());
+}
+
+void MainComponent::setGuiUpdateRate(int updatesPerSecond, bool performanceMode)
+{
+	// performance mode freezes the readouts and the head, only the connection state is kept up to date
+	m_performanceMode = performanceMode;
+	startTimerHz(performanceMode ? 2 : jlimit(1, 60, updatesPerSecond));
 }
 
 void MainComponent::refreshPortList()
@@ -393,7 +587,8 @@ void MainComponent::refreshPortList()
 
 void MainComponent::updateBridgeSettings()
 {
-	bridge.PortN = m_portListCB.getSelectedItemIndex();
+	if (!bridge.isSerialConnected())
+		bridge.PortN = m_portListCB.getSelectedItemIndex();
 
 	if (m_quatsOscAddress.getText().isEmpty()) m_quatsOscAddress.setText("/quaternions", dontSendNotification);
 	if (m_rollOscAddress.getText().isEmpty()) m_rollOscAddress.setText("/roll", dontSendNotification);
@@ -488,13 +683,79 @@ void MainComponent::loadSettings()
 		m_yprOrderCB.setSelectedId(appSettings.getUserSettings()->getIntValue("yprOrderCB"), dontSendNotification);
 		m_ipAddress.setText(appSettings.getUserSettings()->getValue("ipAddress"), dontSendNotification);
 		m_portNumber.setText(appSettings.getUserSettings()->getValue("portNumber"), dontSendNotification);
+		if (appSettings.getUserSettings()->containsKey("oscInputPort"))
+		{
+			m_serialInputButton.setToggleState(appSettings.getUserSettings()->getBoolValue("serialInput"), dontSendNotification);
+			m_oscInputButton.setToggleState(appSettings.getUserSettings()->getBoolValue("oscInput"), dontSendNotification);
+			m_oscInputPort.setText(appSettings.getUserSettings()->getValue("oscInputPort"), dontSendNotification);
+			m_oscInputAddress.setText(appSettings.getUserSettings()->getValue("oscInputAddress"), dontSendNotification);
+		}
+		m_driftButton.setToggleState(appSettings.getUserSettings()->getBoolValue("driftCompensation"), dontSendNotification);
 		updateBridgeSettings();
+
+		// lower values win while their source is fresh, the serial tracker is preferred by default
+		bridge.setInputPriorities(appSettings.getUserSettings()->getIntValue("serialInputPriority", 0),
+			appSettings.getUserSettings()->getIntValue("oscInputPriority", 1));
+		bridge.setStaleTimeout(appSettings.getUserSettings()->getIntValue("inputStaleTimeoutUs", 100000));
+
+		// further OSC inputs as "port:address:trackerId:priority", e.g. "9001:/phone/quat:0:2"
+		StringArray oscInputs = StringArray::fromTokens(appSettings.getUserSettings()->getValue("additionalOscInputs"), ",", "\"");
+		oscInputs.trim();
+		oscInputs.removeEmptyStrings();
+		for (auto& input : oscInputs)
+		{
+			StringArray fields = StringArray::fromTokens(input, ":", "");
+			if (fields.size() == 4)
+				bridge.addOscInput(fields[0].getIntValue(), fields[1].trim(), fields[2].getIntValue(), fields[3].getIntValue());
+		}
+
+		// further trackers are listed by port name, e.g. "ttyACM1, ttyACM2"
+		StringArray trackerPorts = StringArray::fromTokens(appSettings.getUserSettings()->getValue("additionalTrackers"), ",", "\"");
+		trackerPorts.trim();
+		trackerPorts.removeEmptyStrings();
+		for (auto& portName : trackerPorts)
+			bridge.addTracker(portName);
+
+		// per tracker destinations, e.g. "1=192.168.0.11:9000, 2=192.168.0.12:9000"
+		bridge.setupRoutes(appSettings.getUserSettings()->getValue("oscRoutes"));
+
+		// optional custom head model, a path to an OBJ file
+		const String headModel = appSettings.getUserSettings()->getValue("headModel");
+		if (headModel.isNotEmpty() && File::isAbsolutePath(headModel))
+			m_binauralHeadView.setHeadModel(File(headModel));
+
+		// "software" forces the 2D preview, e.g. for testing on machines without a GPU
+		if (appSettings.getUserSettings()->getValue("headViewRenderer") == "software")
+			m_binauralHeadView.setSoftwareRendering(true);
 	}
 	else
 	{
 		m_ipAddress.setText("127.0.0.1", dontSendNotification); // ip address is not stored with presets
 		loadPreset(1);
 	}
+
+	updateDriftCompensation();
+
+	// firmware health reports, once per second per tracker
+	bridge.setupTelemetryOSC(appSettings.getUserSettings()->getBoolValue("telemetryOscActive", true),
+		appSettings.getUserSettings()->getValue("telemetryOscAddress", "/bridge/telemetry"));
+
+	// 9-axis heading, used once the compass has been calibrated
+	bridge.setCompassCalibration(appSettings.getUserSettings()->getValue("compassCalibration"));
+	bridge.setCompassFusion(appSettings.getUserSettings()->getBoolValue("compassFusion", true),
+		appSettings.getUserSettings()->getDoubleValue("compassTimeConstant", 5.0));
+
+	// Reset blends to the new reference, 0 s switches at once like before
+	bridge.setResetTransition(appSettings.getUserSettings()->getDoubleValue("resetTransitionTime", 0.0),
+		appSettings.getUserSettings()->getDoubleValue("resetAveragingTime", 0.2));
+
+	// "/bridge/reset" on this port resets remotely, 0 disables it
+	const int controlPort = appSettings.getUserSettings()->getIntValue("oscControlPort", 0);
+	if (controlPort > 0 && !bridge.connectControlReceiver(controlPort))
+		AlertWindow::showMessageBoxAsync(AlertWindow::NoIcon, "OSC control", "Can't receive on port " + String(controlPort), "OK");
+
+	setGuiUpdateRate(appSettings.getUserSettings()->getIntValue("guiUpdateRate", 20),
+		appSettings.getUserSettings()->getBoolValue("performanceMode", false));
 }
 
 void MainComponent::saveSettings()
@@ -520,6 +781,11 @@ void MainComponent::saveSettings()
 	appSettings.getUserSettings()->setValue("yprOrderCB", m_yprOrderCB.getSelectedId());
 	appSettings.getUserSettings()->setValue("ipAddress", m_ipAddress.getText());
 	appSettings.getUserSettings()->setValue("portNumber", m_portNumber.getText());
+	appSettings.getUserSettings()->setValue("serialInput", m_serialInputButton.getToggleState());
+	appSettings.getUserSettings()->setValue("oscInput", m_oscInputButton.getToggleState());
+	appSettings.getUserSettings()->setValue("oscInputPort", m_oscInputPort.getText());
+	appSettings.getUserSettings()->setValue("oscInputAddress", m_oscInputAddress.getText());
+	appSettings.getUserSettings()->setValue("driftCompensation", m_driftButton.getToggleState());
 	appSettings.getUserSettings()->setValue("loadSettingsFile", true);
 }
 
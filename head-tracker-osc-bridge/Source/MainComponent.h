@@ -26,6 +26,8 @@
 #include "Bridge.h"
 #include "SMLookAndFeel.h"
 #include "BinauralHeadView.h"
+#include "NumericReadout.h"
+#include "TracePlot.h"
 
 class MainComponent   : public Component,
 						public Button::Listener,
@@ -44,6 +46,13 @@ public:
 
 private:
 	void switchInput();
+	void updateResetButton();
+	void updateDriftCompensation();
+	void configureDevice();
+	void checkSelfTest();
+	void checkTelemetry();
+	Rectangle<int> getTelemetryArea() const;
+	void setGuiUpdateRate(int updatesPerSecond, bool performanceMode);
 	void refreshPortList();
 	void updateBridgeSettings();
 	bool validateQuatsKey();
@@ -54,18 +63,23 @@ private:
 
 	ApplicationProperties appSettings;
 	TextButton m_serialInputButton, m_oscInputButton;
-	TextButton m_refreshButton, m_connectButton, m_resetButton;
+	TextButton m_refreshButton, m_connectButton, m_resetButton, m_driftButton, m_compassButton, m_selfTestButton;
 	TextButton m_quatsOscActive, m_rollOscActive, m_pitchOscActive, m_yawOscActive, m_rpyOscActive;
 	ComboBox m_portListCB, m_yprOrderCB, m_oscPresetCB;
-	Label m_rollLabel, m_pitchLabel, m_yawLabel;
 	Label m_quatsKeyLabel;
 	Array<int> m_quatsOrder, m_quatsSigns;
 
 	Label m_quatsOscAddress, m_rollOscAddress, m_pitchOscAddress, m_yawOscAddress, m_rpyOscAddress;
 	Label m_rollOscMin, m_pitchOscMin, m_yawOscMin;
 	Label m_rollOscMax, m_pitchOscMax, m_yawOscMax;
-	Label m_rollOscVal, m_pitchOscVal, m_yawOscVal;
+	NumericReadout m_orientationReadout { 3, 1, true }; // roll, pitch, yaw
+	NumericReadout m_oscValueReadout { 3, 2, false };
+	TracePlot m_tracePlot { 3, 5000 };
+	bool m_performanceMode = false;
+	int m_selfTestSequence = 0;
+	Tracker::Telemetry m_telemetry;
 	Label m_ipAddress, m_portNumber;
+	Label m_oscInputPort, m_oscInputAddress;
 	
 	Bridge bridge;
 
@@ -0,0 +1,182 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "NumericReadout.h"
+
+NumericReadout::NumericReadout(int numRows, int numDecimals, bool showDegrees)
+	: m_numDecimals(numDecimals)
+	, m_showDegrees(showDegrees)
+{
+	setInterceptsMouseClicks(false, false);
+	m_rows.resize(numRows);
+
+	for (auto& row : m_rows)
+		formatRow(row);
+}
+
+void NumericReadout::setFont(const Font& font)
+{
+	m_font = font;
+	m_glyphScale = 0.0f;
+	repaint();
+}
+
+void NumericReadout::setColour(Colour colour)
+{
+	m_colour = colour;
+	m_glyphScale = 0.0f;
+	repaint();
+}
+
+void NumericReadout::setRowHeight(int rowHeight)
+{
+	m_rowHeight = rowHeight;
+	m_glyphScale = 0.0f;
+	repaint();
+}
+
+void NumericReadout::setValue(int row, float value)
+{
+	auto& r = m_rows.getReference(row);
+
+	double scaled = value;
+	for (int i = 0; i < m_numDecimals; ++i)
+		scaled *= 10.0;
+
+	const int quantisedValue = roundToInt(jlimit(-1.0e8, 1.0e8, scaled));
+	if (quantisedValue == r.quantisedValue)
+		return;
+
+	r.quantisedValue = quantisedValue;
+	formatRow(r);
+	m_changedRows.setBit(row);
+}
+
+void NumericReadout::flushChanges()
+{
+	if (m_changedRows.isZero())
+		return;
+
+	Rectangle<int> area;
+	for (int row = m_changedRows.findNextSetBit(0); row >= 0; row = m_changedRows.findNextSetBit(row + 1))
+		area = area.getUnion(getRowArea(row));
+
+	m_changedRows.clear();
+	repaint(area);
+}
+
+void NumericReadout::formatRow(Row& row) const
+{
+	// digits are written backwards from the least significant one
+	uint8 reversed[maxChars];
+	int n = 0;
+	int64 magnitude = std::abs((int64)row.quantisedValue);
+
+	if (m_showDegrees)
+		reversed[n++] = numGlyphs - 1;
+
+	for (int digit = 0; digit <= m_numDecimals || magnitude > 0; ++digit)
+	{
+		if (digit == m_numDecimals && m_numDecimals > 0)
+			reversed[n++] = 11; // '.'
+
+		reversed[n++] = (uint8)(magnitude % 10);
+		magnitude /= 10;
+	}
+
+	if (row.quantisedValue < 0)
+		reversed[n++] = 10; // '-'
+
+	row.numChars = n;
+	for (int i = 0; i < n; ++i)
+		row.glyphs[i] = reversed[n - 1 - i];
+}
+
+void NumericReadout::updateGlyphCache(float scale)
+{
+	const String glyphs = String(glyphChars) + String::charToString((juce_wchar)0x00b0);
+
+	int digitWidth = 0;
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		m_glyphAdvance[i] = roundToInt(m_font.getStringWidthFloat(glyphs.substring(i, i + 1))) + 1;
+		if (i < 10)
+			digitWidth = jmax(digitWidth, m_glyphAdvance[i]);
+	}
+
+	int cacheWidth = 0;
+	for (int i = 0; i < numGlyphs; ++i)
+	{
+		if (i < 10)
+			m_glyphAdvance[i] = digitWidth;
+
+		m_glyphX[i] = cacheWidth;
+		cacheWidth += m_glyphAdvance[i];
+	}
+
+	m_glyphCache = Image(Image::ARGB, roundToInt(scale * cacheWidth), roundToInt(scale * m_rowHeight), true);
+	Graphics g(m_glyphCache);
+	g.addTransform(AffineTransform::scale(scale));
+	g.setFont(m_font);
+	g.setColour(m_colour);
+
+	for (int i = 0; i < numGlyphs; ++i)
+		g.drawText(glyphs.substring(i, i + 1), m_glyphX[i], 0, m_glyphAdvance[i], m_rowHeight, Justification::centred, false);
+
+	m_glyphScale = scale;
+}
+
+Rectangle<int> NumericReadout::getRowArea(int row) const
+{
+	return { 0, row * m_rowHeight, getWidth(), m_rowHeight };
+}
+
+void NumericReadout::paint(Graphics& g)
+{
+	const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+	if (scale != m_glyphScale || m_glyphCache.isNull())
+		updateGlyphCache(scale);
+
+	// digits share one advance so the columns don't jitter while values change
+	for (int i = 0; i < m_rows.size(); ++i)
+	{
+		const auto& row = m_rows.getReference(i);
+		const int y = i * m_rowHeight;
+
+		if (!g.clipRegionIntersects(getRowArea(i)))
+			continue;
+
+		int x = getWidth();
+		for (int c = 0; c < row.numChars; ++c)
+			x -= m_glyphAdvance[row.glyphs[c]];
+
+		for (int c = 0; c < row.numChars; ++c)
+		{
+			const int glyph = row.glyphs[c];
+			g.drawImage(m_glyphCache, x, y, m_glyphAdvance[glyph], m_rowHeight,
+				roundToInt(m_glyphScale * m_glyphX[glyph]), 0, roundToInt(m_glyphScale * m_glyphAdvance[glyph]), m_glyphCache.getHeight());
+			x += m_glyphAdvance[glyph];
+		}
+	}
+}
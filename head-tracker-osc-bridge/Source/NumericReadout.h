@@ -0,0 +1,79 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+	A column of right aligned numbers drawn from a cache of prerendered
+	glyphs. Values are quantised to the displayed precision, an update
+	only repaints the rows whose text actually changed, in one call.
+*/
+class NumericReadout : public Component
+{
+public:
+	NumericReadout(int numRows, int numDecimals, bool showDegrees);
+
+	void setFont(const Font& font);
+	void setColour(Colour colour);
+	void setRowHeight(int rowHeight);
+	void setValue(int row, float value);
+	void flushChanges();
+
+	void paint(Graphics& g) override;
+
+private:
+	// characters used by the readout, the degree sign is appended as the last glyph
+	static constexpr const char* glyphChars = "0123456789-.";
+	static constexpr int numGlyphs = 13;
+	static constexpr int maxChars = 12;
+
+	struct Row
+	{
+		int quantisedValue = 0;
+		int numChars = 0;
+		uint8 glyphs[maxChars];
+	};
+
+	void formatRow(Row& row) const;
+	void updateGlyphCache(float scale);
+	Rectangle<int> getRowArea(int row) const;
+
+	const int m_numDecimals;
+	const bool m_showDegrees;
+	Array<Row> m_rows;
+	BigInteger m_changedRows;
+
+	Font m_font;
+	Colour m_colour = Colours::white;
+	int m_rowHeight = 20;
+
+	// the digits share the widest advance, the sign, point and degree sign keep their own
+	Image m_glyphCache;
+	float m_glyphScale = 0.0f;
+	int m_glyphX[numGlyphs] = {}, m_glyphAdvance[numGlyphs] = {};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NumericReadout)
+};
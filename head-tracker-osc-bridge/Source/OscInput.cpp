@@ -0,0 +1,165 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OscInput.h"
+
+OscInput::OscInput(Tracker& tracker, CriticalSection& lock)
+	: m_tracker(tracker)
+	, m_lock(lock)
+{
+	m_receiver.addListener(this);
+}
+
+OscInput::~OscInput()
+{
+	disconnect();
+	m_receiver.removeListener(this);
+}
+
+bool OscInput::connect(int portNumber, const String& address)
+{
+	disconnect();
+
+	// an invalid address throws, the input stays disconnected then
+	try
+	{
+		m_address.reset(new OSCAddress(address));
+	}
+	catch (const OSCFormatError&)
+	{
+		return false;
+	}
+
+	m_portNumber = portNumber;
+	m_isConnected = m_receiver.connect(portNumber);
+	return m_isConnected;
+}
+
+void OscInput::disconnect()
+{
+	m_receiver.disconnect();
+	stopTimer();
+	m_isConnected = false;
+
+	const ScopedLock sl(m_lock);
+	m_scheduledSamples.clear();
+}
+
+bool OscInput::isConnected() const
+{
+	return m_isConnected;
+}
+
+int OscInput::getPortNumber() const
+{
+	return m_portNumber;
+}
+
+Tracker& OscInput::getTracker()
+{
+	return m_tracker;
+}
+
+void OscInput::oscMessageReceived(const OSCMessage& message)
+{
+	handleMessage(message, OSCTimeTag::immediately);
+}
+
+void OscInput::oscBundleReceived(const OSCBundle& bundle)
+{
+	// every element counts, nested bundles carry their own timetag
+	for (auto& element : bundle)
+	{
+		if (element.isBundle())
+			oscBundleReceived(element.getBundle());
+		else if (element.isMessage())
+			handleMessage(element.getMessage(), bundle.getTimeTag());
+	}
+}
+
+void OscInput::handleMessage(const OSCMessage& message, OSCTimeTag timeTag)
+{
+	if (m_address == nullptr || message.size() != 4 || !message.getAddressPattern().matches(*m_address))
+		return;
+
+	for (auto& argument : message)
+		if (!argument.isFloat32())
+			return;
+
+	// like the serial frames, a quaternion that can't be normalised is dropped before it poisons the outputs
+	const float q[4] = { message[0].getFloat32(), message[1].getFloat32(), message[2].getFloat32(), message[3].getFloat32() };
+	const double magnitudeSquared = (double)q[0] * q[0] + (double)q[1] * q[1] + (double)q[2] * q[2] + (double)q[3] * q[3];
+	if (!std::isfinite(magnitudeSquared) || magnitudeSquared < 0.01)
+		return;
+
+	const ScopedLock sl(m_lock);
+
+	const int64 now = Time::currentTimeMillis();
+	const int64 timeMs = timeTag.isImmediately() ? now : timeTag.toTime().toMilliseconds();
+
+	if (timeMs <= now || timeMs > now + m_maxScheduleDelayMs)
+	{
+		m_tracker.setQuaternion(q[0], q[1], q[2], q[3]);
+		return;
+	}
+
+	if (m_scheduledSamples.size() >= m_maxScheduledSamples)
+		applyScheduledSamples();
+
+	ScheduledSample sample { timeMs, { q[0], q[1], q[2], q[3] } };
+
+	int index = m_scheduledSamples.size();
+	while (index > 0 && m_scheduledSamples.getReference(index - 1).timeMs > timeMs)
+		--index;
+	m_scheduledSamples.insert(index, sample);
+
+	if (!isTimerRunning())
+		startTimer(1);
+}
+
+void OscInput::hiResTimerCallback()
+{
+	const ScopedLock sl(m_lock);
+	applyScheduledSamples();
+
+	if (m_scheduledSamples.isEmpty())
+		stopTimer();
+}
+
+void OscInput::applyScheduledSamples()
+{
+	const int64 now = Time::currentTimeMillis();
+
+	// when the queue overflows the oldest sample is applied early
+	int numDue = m_scheduledSamples.size() >= m_maxScheduledSamples ? 1 : 0;
+	while (numDue < m_scheduledSamples.size() && m_scheduledSamples.getReference(numDue).timeMs <= now)
+		++numDue;
+
+	for (int i = 0; i < numDue; ++i)
+	{
+		const auto& sample = m_scheduledSamples.getReference(i);
+		m_tracker.setQuaternion(sample.quaternion[0], sample.quaternion[1],
+								sample.quaternion[2], sample.quaternion[3]);
+	}
+	m_scheduledSamples.removeRange(0, numDue);
+}
@@ -0,0 +1,73 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Tracker.h"
+
+/*
+	OSC orientation input: a receiver on a configurable port and address
+	feeding a tracker. Bundles are processed element by element, samples
+	with a future timetag are queued and applied when they are due.
+*/
+class OscInput	: private OSCReceiver::Listener<OSCReceiver::RealtimeCallback>
+				, private HighResolutionTimer
+{
+public:
+	OscInput(Tracker& tracker, CriticalSection& lock);
+	~OscInput();
+
+	bool connect(int portNumber, const String& address);
+	void disconnect();
+	bool isConnected() const;
+	int getPortNumber() const;
+	Tracker& getTracker();
+
+private:
+	void oscMessageReceived(const OSCMessage& message) override;
+	void oscBundleReceived(const OSCBundle& bundle) override;
+	void hiResTimerCallback() override;
+	void handleMessage(const OSCMessage& message, OSCTimeTag timeTag);
+	void applyScheduledSamples();
+
+	struct ScheduledSample
+	{
+		int64 timeMs;
+		float quaternion[4];
+	};
+
+	Tracker& m_tracker;
+	CriticalSection& m_lock;
+
+	OSCReceiver m_receiver;
+	std::unique_ptr<OSCAddress> m_address;
+	int m_portNumber = 0;
+	bool m_isConnected = false;
+
+	Array<ScheduledSample> m_scheduledSamples;
+	const int m_maxScheduledSamples = 256;
+	const int64 m_maxScheduleDelayMs = 1000; // later timetags are treated as clock skew
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscInput)
+};
@@ -0,0 +1,145 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OscRouting.h"
+
+static int oscPaddedSize(int numBytes)
+{
+	// OSC strings are null terminated and padded to a multiple of 4 bytes
+	return (numBytes + 4) & ~3;
+}
+
+void OscFloatMessage::prepare(const String& address, int numFloats)
+{
+	const int addressSize = oscPaddedSize((int)strlen(address.toRawUTF8()));
+	const int typeTagSize = oscPaddedSize(1 + numFloats);
+
+	m_numFloats = numFloats;
+	m_payloadOffset = addressSize + typeTagSize;
+	m_data.setSize((size_t)(m_payloadOffset + 4 * numFloats), true);
+
+	char* data = static_cast<char*>(m_data.getData());
+	memcpy(data, address.toRawUTF8(), strlen(address.toRawUTF8()));
+
+	data[addressSize] = ',';
+	for (int i = 0; i < numFloats; ++i)
+		data[addressSize + 1 + i] = 'f';
+}
+
+void OscFloatMessage::setFloat(int index, float value)
+{
+	jassert(isPositiveAndBelow(index, m_numFloats));
+
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	bits = ByteOrder::swapIfLittleEndian(bits);
+	memcpy(static_cast<char*>(m_data.getData()) + m_payloadOffset + 4 * index, &bits, sizeof(bits));
+}
+
+String OscAddressTemplate::expand(const String& addressTemplate, int trackerId)
+{
+	if (addressTemplate.contains("{id}"))
+		return addressTemplate.replace("{id}", String(trackerId));
+
+	if (trackerId == 0)
+		return addressTemplate;
+
+	return "/tracker/" + String(trackerId) + addressTemplate;
+}
+
+OscDestination::OscDestination(const String& ipAddress, int portNumber)
+	: m_ipAddress(ipAddress)
+	, m_portNumber(portNumber)
+{
+	m_socket.bindToPort(0);
+}
+
+bool OscDestination::matches(const String& ipAddress, int portNumber) const
+{
+	return m_ipAddress == ipAddress && m_portNumber == portNumber;
+}
+
+void OscDestination::send(const OscFloatMessage& message)
+{
+	if (m_portNumber > 0)
+		m_socket.write(m_ipAddress, m_portNumber, message.getData(), message.getSize());
+}
+
+OscRouter::OscRouter()
+	: m_defaultDestination(new OscDestination(String(), 0))
+{
+}
+
+void OscRouter::setDefaultDestination(const String& ipAddress, int portNumber)
+{
+	if (!m_defaultDestination->matches(ipAddress, portNumber))
+		m_defaultDestination.reset(new OscDestination(ipAddress, portNumber));
+}
+
+void OscRouter::setRoute(int trackerId, const String& ipAddress, int portNumber)
+{
+	for (auto* destination : m_destinations)
+	{
+		if (destination->matches(ipAddress, portNumber))
+		{
+			m_routes.set(trackerId, destination);
+			return;
+		}
+	}
+
+	m_routes.set(trackerId, m_destinations.add(new OscDestination(ipAddress, portNumber)));
+}
+
+void OscRouter::clearRoutes()
+{
+	m_routes.clear();
+	m_destinations.clear();
+}
+
+void OscRouter::setRoutes(const String& rules)
+{
+	clearRoutes();
+
+	StringArray ruleList = StringArray::fromTokens(rules, ",;", "\"");
+	ruleList.trim();
+	ruleList.removeEmptyStrings();
+
+	for (auto& rule : ruleList)
+	{
+		const String destination = rule.fromFirstOccurrenceOf("=", false, false).trim();
+		if (!rule.containsChar('=') || !destination.containsChar(':'))
+			continue;
+
+		setRoute(rule.upToFirstOccurrenceOf("=", false, false).trim().getIntValue(),
+			destination.upToLastOccurrenceOf(":", false, false),
+			destination.fromLastOccurrenceOf(":", false, false).getIntValue());
+	}
+}
+
+OscDestination& OscRouter::getDestination(int trackerId)
+{
+	if (m_routes.contains(trackerId))
+		return *m_routes[trackerId];
+
+	return *m_defaultDestination;
+}
@@ -0,0 +1,100 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+	OSC message with a fixed address and a fixed number of float arguments.
+	The address and type tags are encoded once, sending a sample only
+	patches the float payload.
+*/
+class OscFloatMessage
+{
+public:
+	OscFloatMessage() {}
+
+	void prepare(const String& address, int numFloats);
+	void setFloat(int index, float value);
+
+	const void* getData() const { return m_data.getData(); }
+	int getSize() const { return (int)m_data.getSize(); }
+
+private:
+	MemoryBlock m_data;
+	int m_payloadOffset = 0;
+	int m_numFloats = 0;
+};
+
+/*
+	Output addresses like "/listener/{id}/quaternion" are templates, {id} is
+	replaced by the tracker id. Templates without {id} are used as they are
+	for the primary tracker and get a "/tracker/<id>" prefix for the others.
+*/
+struct OscAddressTemplate
+{
+	static String expand(const String& addressTemplate, int trackerId);
+};
+
+class OscDestination
+{
+public:
+	OscDestination(const String& ipAddress, int portNumber);
+
+	bool matches(const String& ipAddress, int portNumber) const;
+	void send(const OscFloatMessage& message);
+
+private:
+	String m_ipAddress;
+	int m_portNumber;
+	DatagramSocket m_socket;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscDestination)
+};
+
+/*
+	Maps tracker ids to destinations, trackers without a route are sent
+	to the default destination.
+*/
+class OscRouter
+{
+public:
+	OscRouter();
+
+	void setDefaultDestination(const String& ipAddress, int portNumber);
+	void setRoute(int trackerId, const String& ipAddress, int portNumber);
+	void clearRoutes();
+
+	// parses routing rules like "1=192.168.0.11:9000, 2=192.168.0.12:9000"
+	void setRoutes(const String& rules);
+
+	OscDestination& getDestination(int trackerId);
+
+private:
+	std::unique_ptr<OscDestination> m_defaultDestination;
+	OwnedArray<OscDestination> m_destinations;
+	HashMap<int, OscDestination*> m_routes;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscRouter)
+};
@@ -0,0 +1,177 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TracePlot.h"
+
+TracePlot::TracePlot(int numChannels, uint32 historyMs)
+	: m_numChannels(jlimit(1, (int)maxChannels, numChannels))
+	, m_historyMs(historyMs)
+{
+	setOpaque(true);
+	setInterceptsMouseClicks(false, false);
+
+	for (auto& colour : m_channelColours)
+		colour = Colours::white;
+}
+
+void TracePlot::setChannel(int channel, const String& name, Colour colour)
+{
+	if (isPositiveAndBelow(channel, m_numChannels))
+	{
+		m_channelNames[channel] = name;
+		m_channelColours[channel] = colour;
+	}
+}
+
+void TracePlot::setBackgroundColour(Colour colour)
+{
+	m_backgroundColour = colour;
+}
+
+void TracePlot::resized()
+{
+	// one column per pixel, the history starts over
+	Column empty;
+	empty.hasData = false;
+
+	m_columns.clearQuick();
+	m_columns.insertMultiple(0, empty, jmax(1, getWidth()));
+	m_newestColumn = 0;
+	m_newestBin = 0;
+	m_binMs = jmax((uint32)1, m_historyMs / (uint32)m_columns.size());
+}
+
+void TracePlot::advanceColumns(int64 bin)
+{
+	if (m_newestBin == 0)
+		m_newestBin = bin;
+
+	const int64 steps = jmin(bin - m_newestBin, (int64)m_columns.size());
+	for (int64 i = 0; i < steps; ++i)
+	{
+		m_newestColumn = (m_newestColumn + 1) % m_columns.size();
+		m_columns.getReference(m_newestColumn).hasData = false;
+	}
+
+	if (bin > m_newestBin)
+	{
+		m_newestBin = bin;
+		m_changed = true;
+	}
+}
+
+void TracePlot::addSample(uint32 timeMs, const float* values)
+{
+	if (m_columns.isEmpty())
+		return;
+
+	const int64 bin = timeMs / m_binMs;
+	advanceColumns(bin);
+
+	const int64 age = m_newestBin - bin;
+	if (age < 0 || age >= m_columns.size())
+		return;
+
+	auto& column = m_columns.getReference((int)((m_newestColumn - age + m_columns.size()) % m_columns.size()));
+
+	for (int c = 0; c < m_numChannels; ++c)
+	{
+		column.minimum[c] = column.hasData ? jmin(column.minimum[c], values[c]) : values[c];
+		column.maximum[c] = column.hasData ? jmax(column.maximum[c], values[c]) : values[c];
+	}
+
+	column.hasData = true;
+	m_changed = true;
+}
+
+void TracePlot::advanceTo(uint32 timeMs)
+{
+	if (m_columns.isEmpty())
+		return;
+
+	advanceColumns(timeMs / m_binMs);
+
+	if (m_changed)
+	{
+		m_changed = false;
+		repaint();
+	}
+}
+
+float TracePlot::getVisibleRange() const
+{
+	// the scale follows the largest visible value so jitter stays readable
+	float largest = 0.0f;
+	for (auto& column : m_columns)
+		if (column.hasData)
+			for (int c = 0; c < m_numChannels; ++c)
+				largest = jmax(largest, std::abs(column.minimum[c]), std::abs(column.maximum[c]));
+
+	for (auto range : { 5.0f, 10.0f, 20.0f, 45.0f, 90.0f })
+		if (largest <= range)
+			return range;
+
+	return 180.0f;
+}
+
+void TracePlot::paint(Graphics& g)
+{
+	g.fillAll(m_backgroundColour);
+
+	const float range = getVisibleRange();
+	const float height = (float)getHeight();
+	auto toY = [range, height](float value) { return jmap(value, range, -range, 0.0f, height); };
+
+	g.setColour(m_backgroundColour.contrasting(0.2f));
+	g.drawHorizontalLine(roundToInt(toY(0.0f)), 0.0f, (float)getWidth());
+
+	// oldest column on the left
+	for (int x = 0; x < m_columns.size(); ++x)
+	{
+		const auto& column = m_columns.getReference((m_newestColumn + 1 + x) % m_columns.size());
+		if (!column.hasData)
+			continue;
+
+		for (int c = 0; c < m_numChannels; ++c)
+		{
+			const float top = toY(column.maximum[c]);
+			g.setColour(m_channelColours[c]);
+			g.fillRect((float)x, top, 1.0f, jmax(1.0f, toY(column.minimum[c]) - top));
+		}
+	}
+
+	g.setColour(m_backgroundColour.contrasting(0.5f));
+	g.setFont(11.0f);
+	g.drawText(String::charToString((juce_wchar)0x00b1) + String((int)range) + String::charToString((juce_wchar)0x00b0),
+		2, 0, 60, 14, Justification::topLeft, false);
+
+	int legendX = getWidth() - 2;
+	for (int c = m_numChannels; --c >= 0;)
+	{
+		const int width = roundToInt(g.getCurrentFont().getStringWidthFloat(m_channelNames[c])) + 6;
+		legendX -= width;
+		g.setColour(m_channelColours[c]);
+		g.drawText(m_channelNames[c], legendX, 0, width, 14, Justification::topRight, false);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+	Scrolling plot of a few channels over a fixed time span. Every pixel
+	column keeps the minimum and maximum of the samples that fell into
+	it, so the cost of drawing doesn't depend on the input rate. Columns
+	without samples are left empty, dropouts show up as gaps.
+*/
+class TracePlot : public Component
+{
+public:
+	static constexpr int maxChannels = 3;
+
+	TracePlot(int numChannels, uint32 historyMs);
+
+	void setChannel(int channel, const String& name, Colour colour);
+	void setBackgroundColour(Colour colour);
+
+	void addSample(uint32 timeMs, const float* values);
+	void advanceTo(uint32 timeMs); // scrolls and repaints if anything changed
+
+	void paint(Graphics& g) override;
+	void resized() override;
+
+private:
+	struct Column
+	{
+		float minimum[maxChannels];
+		float maximum[maxChannels];
+		bool hasData;
+	};
+
+	void advanceColumns(int64 bin);
+	float getVisibleRange() const;
+
+	const int m_numChannels;
+	const uint32 m_historyMs;
+	String m_channelNames[maxChannels];
+	Colour m_channelColours[maxChannels];
+	Colour m_backgroundColour = Colours::black;
+
+	Array<Column> m_columns; // ring buffer, m_newestColumn holds the samples of m_newestBin
+	int m_newestColumn = 0;
+	int64 m_newestBin = 0;
+	uint32 m_binMs = 1;
+	bool m_changed = false;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TracePlot)
+};
@@ -0,0 +1,663 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Tracker.h"
+
+static void rotateAboutVertical(double& w, double& x, double& y, double& z, double radians)
+{
+	// q = rotation about the vertical axis * q
+	const double c = cos(radians / 2), s = sin(radians / 2);
+	const double qw = w, qx = x, qy = y, qz = z;
+	w = c * qw - s * qz;
+	x = c * qx - s * qy;
+	y = c * qy + s * qx;
+	z = c * qz + s * qw;
+}
+
+static void slerp(const double* from, const double* to, double t, double* result)
+{
+	double cosTheta = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+	const double sign = cosTheta < 0.0 ? -1.0 : 1.0; // take the short way round
+	cosTheta *= sign;
+
+	double a = 1.0 - t, b = t;
+	if (cosTheta < 0.9995)
+	{
+		const double theta = acos(cosTheta);
+		a = sin(a * theta) / sin(theta);
+		b = sin(b * theta) / sin(theta);
+	}
+	b *= sign;
+
+	double magnitude = 0.0;
+	for (int i = 0; i < 4; ++i)
+	{
+		result[i] = a * from[i] + b * to[i];
+		magnitude += result[i] * result[i];
+	}
+
+	magnitude = sqrt(magnitude);
+	for (int i = 0; i < 4; ++i)
+		result[i] /= magnitude;
+}
+
+Tracker::Tracker(int id, Listener& listener)
+	: m_id(id)
+	, m_listener(listener)
+{
+}
+
+Tracker::~Tracker()
+{
+	close();
+}
+
+int Tracker::getId() const
+{
+	return m_id;
+}
+
+bool Tracker::open(const String& portName, int baudRate)
+{
+	close();
+
+	if (m_listener.isPortClaimed(portName, this))
+		return false;
+
+	m_portName = portName;
+	m_baudRate = baudRate;
+	m_portIndex = comFindPort(portName.toRawUTF8());
+
+	m_deviceCommands.clear();
+	m_deviceConfig = DeviceConfig();
+	m_telemetry = Telemetry();
+	m_selfTestDeadline = 0;
+
+	if (m_portIndex >= 0 && comOpen(m_portIndex, m_baudRate) == 1)
+	{
+		m_isOpen = true;
+		m_reconnecting = false;
+		m_serialLineLength = 0;
+		m_lastFrameTime = Time::getMillisecondCounter();
+		return true;
+	}
+
+	if (m_autoReconnect)
+	{
+		// keep waiting for the device to show up
+		m_isOpen = true;
+		beginReconnect(Time::getMillisecondCounter());
+	}
+
+	return false;
+}
+
+void Tracker::close()
+{
+	if (m_probePort >= 0)
+	{
+		comClose(m_probePort);
+		m_probePort = -1;
+	}
+
+	if (m_isOpen && !m_reconnecting)
+		comClose(m_portIndex);
+
+	m_isOpen = false;
+	m_reconnecting = false;
+}
+
+bool Tracker::isOpen() const
+{
+	return m_isOpen;
+}
+
+bool Tracker::isReconnecting() const
+{
+	return m_reconnecting;
+}
+
+void Tracker::setAutoReconnect(bool shouldReconnect)
+{
+	m_autoReconnect = shouldReconnect;
+}
+
+const String& Tracker::getPortName() const
+{
+	return m_portName;
+}
+
+bool Tracker::isUsingPort(const String& portName) const
+{
+	if (!m_isOpen)
+		return false;
+
+	if (m_probePort >= 0)
+		return portName == comGetPortName(m_probePort);
+
+	return !m_reconnecting && portName == m_portName;
+}
+
+void Tracker::refreshPortIndex()
+{
+	// enumeration may move an open port to another index
+	if (m_isOpen && !m_reconnecting)
+		m_portIndex = comFindPort(m_portName.toRawUTF8());
+}
+
+bool Tracker::sendCommand(char tag, const Array<int>& args)
+{
+	String command = "#" + String::charToString(tag);
+	for (int value : args)
+		command << "," << value;
+	command << ";";
+
+	// only the latest command of each kind is kept for a reconnect, queries and tests aren't
+	if (tag != '?' && tag != 'S')
+	{
+		for (int i = m_deviceCommands.size(); --i >= 0;)
+			if (m_deviceCommands[i][1] == tag)
+				m_deviceCommands.remove(i);
+		m_deviceCommands.add(command);
+	}
+
+	if (!writeCommand(command))
+		return false;
+
+	// the device sends nothing until the "#S" answer, about 0.7 s
+	if (tag == 'S')
+		m_selfTestDeadline = Time::getMillisecondCounter() + m_selfTestTimeoutMs;
+
+	return true;
+}
+
+String Tracker::SelfTestResult::toString() const
+{
+	return String(mask)
+		+ "," + String(gyroBias[0]) + "," + String(gyroBias[1]) + "," + String(gyroBias[2])
+		+ "," + String(accelBias[0]) + "," + String(accelBias[1]) + "," + String(accelBias[2]);
+}
+
+bool Tracker::writeCommand(const String& command)
+{
+	if (!m_isOpen || m_reconnecting)
+		return false;
+
+	return comWrite(m_portIndex, command.toRawUTF8(), command.getNumBytesAsUTF8()) > 0;
+}
+
+void Tracker::service(uint32 now)
+{
+	if (!m_isOpen)
+		return;
+
+	if (m_reconnecting)
+	{
+		serviceReconnect(now);
+	}
+	else if (readSerialFrames(m_portIndex))
+	{
+		m_lastFrameTime = now;
+	}
+	else if (m_autoReconnect && now - m_lastFrameTime > m_frameTimeoutMs && now >= m_selfTestDeadline)
+	{
+		beginReconnect(now);
+	}
+}
+
+bool Tracker::readSerialFrames(int portIndex)
+{
+	char readBuffer[128];
+	int bytesRead;
+	bool frameReceived = false;
+
+	while ((bytesRead = comRead(portIndex, readBuffer, sizeof(readBuffer))) > 0)
+	{
+		for (int i = 0; i < bytesRead; ++i)
+		{
+			if (readBuffer[i] == ';')
+			{
+				m_serialLine[m_serialLineLength] = 0;
+				if (parseSerialFrame(m_serialLine))
+					frameReceived = true;
+				m_serialLineLength = 0;
+			}
+			else if (m_serialLineLength < (int)sizeof(m_serialLine) - 1)
+			{
+				m_serialLine[m_serialLineLength++] = readBuffer[i];
+			}
+			else
+			{
+				m_serialLineLength = 0; // garbage, resync on the next separator
+			}
+		}
+	}
+
+	return frameReceived;
+}
+
+bool Tracker::parseSerialFrame(const char* frame)
+{
+	// frames starting with '#' carry events and status instead of orientation
+	if (frame[0] == '#')
+		return parseTaggedFrame(frame + 1);
+
+	// a valid frame consists of four comma separated quaternion values: "qW,qX,qY,qZ"
+	double q[4];
+	if (!parseValues(frame, q, 4))
+		return false;
+
+	// the firmware sends Q14 fixed point integers (1.0 = 16384), other trackers send
+	// floats, a unit quaternion can't get anywhere near the fixed point magnitude
+	double magnitudeSquared = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+	if (magnitudeSquared > 4.0)
+	{
+		for (auto& value : q)
+			value *= 1.0 / 16384.0;
+		magnitudeSquared *= 1.0 / (16384.0 * 16384.0);
+	}
+
+	if (magnitudeSquared < 0.01)
+		return false;
+
+	setQuaternion(q[0], q[1], q[2], q[3]);
+	return true;
+}
+
+bool Tracker::parseValues(const char* text, double* values, int numValues)
+{
+	CharPointer_ASCII t(text);
+
+	for (int i = 0; i < numValues; ++i)
+	{
+		t = t.findEndOfWhitespace();
+		if (t.isEmpty())
+			return false;
+
+		values[i] = CharacterFunctions::readDoubleValue(t);
+		t = t.findEndOfWhitespace();
+
+		if (i < numValues - 1 && t.getAndAdvance() != ',')
+			return false;
+	}
+
+	return t.isEmpty();
+}
+
+bool Tracker::parseTaggedFrame(const char* frame)
+{
+	// "#R": the reset button on the tracker was pressed
+	if (frame[0] == 'R' && frame[1] == 0)
+	{
+		m_listener.trackerResetRequested(*this);
+		return true;
+	}
+
+	// "#M,x,y,z": raw magnetometer reading, aligned with the accelerometer axes
+	if (frame[0] == 'M' && frame[1] == ',')
+	{
+		double field[3];
+		if (!parseValues(frame + 2, field, 3))
+			return false;
+
+		m_compass.addMeasurement(field[0], field[1], field[2]);
+		return true;
+	}
+
+	// "#A,<tag>,<result>": the device answered a command
+	if (frame[0] == 'A' && frame[1] == ',' && frame[2] != 0 && frame[3] == ',')
+	{
+		double result;
+		if (!parseValues(frame + 4, &result, 1))
+			return false;
+
+		m_deviceConfig.lastCommand = frame[2];
+		m_deviceConfig.lastResult = (int)result;
+		return true;
+	}
+
+	// "#C,rate,filter,features,hold": the configuration the device is running with
+	if (frame[0] == 'C' && frame[1] == ',')
+	{
+		double values[4];
+		if (!parseValues(frame + 2, values, 4))
+			return false;
+
+		m_deviceConfig.rate = (int)values[0];
+		m_deviceConfig.filter = (int)values[1];
+		m_deviceConfig.features = (int)values[2];
+		m_deviceConfig.frameHold = (int)values[3];
+		m_deviceConfig.valid = true;
+		return true;
+	}
+
+	// "#I,<serial>": the unique id of the device, hexadecimal
+	if (frame[0] == 'I' && frame[1] == ',')
+	{
+		const String id(frame + 2);
+		if (id.isEmpty() || !id.containsOnly("0123456789ABCDEF"))
+			return false;
+
+		m_deviceConfig.deviceId = id;
+		return true;
+	}
+
+	// "#S,<mask>,gx,gy,gz,ax,ay,az": self-test result, the device id is sent just before
+	if (frame[0] == 'S' && frame[1] == ',')
+	{
+		double values[7];
+		if (!parseValues(frame + 2, values, 7))
+			return false;
+
+		m_selfTest.deviceId = m_deviceConfig.deviceId;
+		m_selfTest.mask = (int)values[0];
+		for (int i = 0; i < 3; ++i)
+		{
+			m_selfTest.gyroBias[i] = (int)values[1 + i];
+			m_selfTest.accelBias[i] = (int)values[4 + i];
+		}
+		++m_selfTest.sequence;
+		m_selfTestDeadline = 0;
+		return true;
+	}
+
+	// "#T,overflows,corrupt,i2c,maxLoopUs,freeRam,temperature": health report, temperature in tenths of a degree
+	if (frame[0] == 'T' && frame[1] == ',')
+	{
+		double values[6];
+		if (!parseValues(frame + 2, values, 6))
+			return false;
+
+		m_telemetry.fifoOverflows = (int)values[0];
+		m_telemetry.corruptPackets = (int)values[1];
+		m_telemetry.i2cErrors = (int)values[2];
+		m_telemetry.maxLoopMicros = (int)values[3];
+		m_telemetry.freeRam = (int)values[4];
+		m_telemetry.temperature = values[5] * 0.1;
+		++m_telemetry.sequence;
+		m_listener.trackerTelemetryReceived(*this);
+		return true;
+	}
+
+	return false;
+}
+
+void Tracker::beginReconnect(uint32 now)
+{
+	// the device stopped streaming: release the handle and wait for it to show up again
+	if (!m_reconnecting)
+		comClose(m_portIndex);
+
+	m_reconnecting = true;
+	m_probeCandidates.clear();
+	m_nextReconnectAttempt = now;
+
+	m_portsAtLoss.clear();
+	for (int i = 0; i < comGetNoPorts(); ++i)
+		if (m_portName != comGetPortName(i))
+			m_portsAtLoss.add(comGetPortName(i));
+}
+
+void Tracker::serviceReconnect(uint32 now)
+{
+	if (m_probePort >= 0)
+	{
+		// the candidate is identified by sending valid orientation frames
+		if (readSerialFrames(m_probePort))
+		{
+			m_portIndex = m_probePort;
+			m_portName = comGetPortName(m_portIndex);
+			m_probePort = -1;
+			m_reconnecting = false;
+			m_lastFrameTime = now;
+
+			// the device restarted with its defaults
+			for (auto& command : m_deviceCommands)
+				writeCommand(command);
+			return;
+		}
+
+		if (now < m_probeDeadline)
+			return;
+
+		comClose(m_probePort);
+		m_probePort = -1;
+	}
+
+	if (now < m_nextReconnectAttempt)
+		return;
+
+	m_nextReconnectAttempt = now + m_reconnectIntervalMs;
+
+	if (m_probeCandidates.isEmpty())
+	{
+		m_listener.trackerRescanPorts();
+
+		// try the original port first, then any port that appeared since the device was lost
+		if (comFindPort(m_portName.toRawUTF8()) >= 0)
+			m_probeCandidates.add(m_portName);
+
+		for (int i = 0; i < comGetNoPorts(); ++i)
+			if (m_portName != comGetPortName(i) && !m_portsAtLoss.contains(comGetPortName(i)))
+				m_probeCandidates.add(comGetPortName(i));
+	}
+
+	while (!m_probeCandidates.isEmpty())
+	{
+		const String candidate = m_probeCandidates[0];
+		m_probeCandidates.remove(0);
+
+		// never steal a port from another tracker
+		if (m_listener.isPortClaimed(candidate, this))
+			continue;
+
+		const int index = comFindPort(candidate.toRawUTF8());
+		if (index >= 0 && comOpen(index, m_baudRate) == 1)
+		{
+			m_probePort = index;
+			m_probeDeadline = now + m_probeTimeoutMs;
+			m_serialLineLength = 0;
+			return;
+		}
+	}
+}
+
+void Tracker::setQuaternion(double w, double x, double y, double z)
+{
+	// normalization (just in case)
+	double magnitude = sqrt(w * w + x * x + y * y + z * z);
+	qlW = w / magnitude;
+	qlX = x / magnitude;
+	qlY = y / magnitude;
+	qlZ = z / magnitude;
+	m_compass.process(qlW, qlX, qlY, qlZ);
+
+	const int64 ticks = Time::getHighResolutionTicks();
+
+	m_newestRecentSample = (m_newestRecentSample + 1) % numElementsInArray(m_recentSamples);
+	m_numRecentSamples = jmin(m_numRecentSamples + 1, (int)numElementsInArray(m_recentSamples));
+	auto& sample = m_recentSamples[m_newestRecentSample];
+	sample.ticks = ticks;
+	sample.q[0] = qlW;
+	sample.q[1] = qlX;
+	sample.q[2] = qlY;
+	sample.q[3] = qlZ;
+
+	if (m_lastSampleTicks != 0)
+	{
+		const double correction = m_driftCompensator.process(qlW, qlX, qlY, qlZ,
+			Time::highResolutionTicksToSeconds(ticks - m_lastSampleTicks));
+		if (correction != 0.0)
+			rotateRebaseYaw(correction);
+	}
+
+	if (m_resetting)
+		updateResetTransition(ticks);
+
+	qW = qbW * qlW + qbX * qlX + qbY * qlY + qbZ * qlZ;
+	qX = qbW * qlX - qbX * qlW - qbY * qlZ + qbZ * qlY;
+	qY = qbW * qlY + qbX * qlZ - qbY * qlW - qbZ * qlX;
+	qZ = qbW * qlZ - qbX * qlY + qbY * qlX - qbZ * qlW;
+
+	updateEuler();
+	m_lastSampleTicks = ticks;
+	m_listener.trackerOrientationChanged(*this);
+}
+
+void Tracker::resetOrientation()
+{
+	getAveragedOrientation(m_resetTo);
+
+	if (m_resetTransitionSeconds <= 0.0)
+	{
+		m_resetting = false;
+		qbW = m_resetTo[0];
+		qbX = m_resetTo[1];
+		qbY = m_resetTo[2];
+		qbZ = m_resetTo[3];
+		return;
+	}
+
+	m_resetFrom[0] = qbW;
+	m_resetFrom[1] = qbX;
+	m_resetFrom[2] = qbY;
+	m_resetFrom[3] = qbZ;
+	m_resetStartTicks = Time::getHighResolutionTicks();
+	m_resetting = true;
+}
+
+void Tracker::setResetTransition(double transitionSeconds, double averagingSeconds)
+{
+	m_resetTransitionSeconds = jmax(0.0, transitionSeconds);
+	m_resetAveragingSeconds = jmax(0.0, averagingSeconds);
+}
+
+void Tracker::getAveragedOrientation(double* q) const
+{
+	q[0] = qlW;
+	q[1] = qlX;
+	q[2] = qlY;
+	q[3] = qlZ;
+
+	if (m_resetAveragingSeconds <= 0.0 || m_numRecentSamples == 0)
+		return;
+
+	// samples close to each other average well component-wise, signs are aligned to the newest one
+	const int64 oldestTicks = m_recentSamples[m_newestRecentSample].ticks
+		- Time::secondsToHighResolutionTicks(m_resetAveragingSeconds);
+	double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+	for (int i = 0; i < m_numRecentSamples; ++i)
+	{
+		const int index = (m_newestRecentSample - i + numElementsInArray(m_recentSamples)) % numElementsInArray(m_recentSamples);
+		const auto& sample = m_recentSamples[index];
+		if (sample.ticks < oldestTicks)
+			break;
+
+		const double sign = sample.q[0] * q[0] + sample.q[1] * q[1] + sample.q[2] * q[2] + sample.q[3] * q[3] < 0.0 ? -1.0 : 1.0;
+		for (int c = 0; c < 4; ++c)
+			sum[c] += sign * sample.q[c];
+	}
+
+	const double magnitude = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2] + sum[3] * sum[3]);
+	if (magnitude > 0.0)
+		for (int c = 0; c < 4; ++c)
+			q[c] = sum[c] / magnitude;
+}
+
+void Tracker::updateResetTransition(int64 ticks)
+{
+	const double t = Time::highResolutionTicksToSeconds(ticks - m_resetStartTicks) / m_resetTransitionSeconds;
+	double q[4];
+
+	if (t >= 1.0)
+	{
+		m_resetting = false;
+		memcpy(q, m_resetTo, sizeof(q));
+	}
+	else
+	{
+		// eased at both ends so the scene doesn't start or stop turning abruptly
+		slerp(m_resetFrom, m_resetTo, t * t * (3.0 - 2.0 * t), q);
+	}
+
+	qbW = q[0];
+	qbX = q[1];
+	qbY = q[2];
+	qbZ = q[3];
+}
+
+void Tracker::setDriftCompensation(const DriftCompensator::Settings& settings)
+{
+	m_driftCompensator.setSettings(settings);
+}
+
+void Tracker::rotateRebaseYaw(double radians)
+{
+	// turning the rebase with the raw quaternion cancels the rotation in the output
+	rotateAboutVertical(qbW, qbX, qbY, qbZ, radians);
+
+	if (m_resetting)
+	{
+		rotateAboutVertical(m_resetFrom[0], m_resetFrom[1], m_resetFrom[2], m_resetFrom[3], radians);
+		rotateAboutVertical(m_resetTo[0], m_resetTo[1], m_resetTo[2], m_resetTo[3], radians);
+	}
+}
+
+void Tracker::updateEuler()
+{
+	const double w = qW, x = qY, y = qX, z = qZ;
+
+	// thanks to Charles Verron (https://www.noisemakers.fr/) for providing the code snippet used below
+
+	double test = x * z + y * w;
+	if (test > 0.499999)
+	{
+		// singularity at north pole
+		m_yaw = 2 * atan2(x, w);
+		m_pitch = MathConstants<double>::pi / 2;
+		m_roll = 0;
+		return;
+	}
+	if (test < -0.499999)
+	{
+		// singularity at south pole
+		m_yaw = -2 * atan2(x, w);
+		m_pitch = -MathConstants<double>::pi / 2;
+		m_roll = 0;
+		return;
+	}
+	double sqx = x * x;
+	double sqy = z * z;
+	double sqz = y * y;
+
+	m_yaw = atan2(2 * z * w - 2 * x * y, 1 - 2 * sqy - 2 * sqz);
+	m_pitch = asin(2 * test);
+	m_roll = atan2(2 * x * w - 2 * z * y, 1 - 2 * sqx - 2 * sqz);
+
+	m_yaw *= -1.0f;
+
+	m_yaw = radiansToDegrees(m_yaw);
+	m_pitch = radiansToDegrees(m_pitch);
+	m_roll = radiansToDegrees(m_roll);
+}
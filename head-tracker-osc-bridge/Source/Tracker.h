@@ -0,0 +1,204 @@
+/*
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Copyright (c) 2017-2019 Tomasz Rudzki, Jacek Majer
+	Email: tom@nvsonic.io
+	Website: https://nvsonic.io/
+	Twitter: @tomasz_rudzki
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "rs232.h"
+#include "DriftCompensator.h"
+#include "CompassFusion.h"
+
+/*
+	A single head tracker: serial frame parser, hot-plug watchdog and
+	rebased orientation. Trackers don't own any threads, the Bridge
+	services all of them from one loop.
+*/
+class Tracker
+{
+public:
+	class Listener
+	{
+	public:
+		virtual ~Listener() {}
+		virtual void trackerOrientationChanged(Tracker& tracker) = 0;
+		virtual void trackerRescanPorts() = 0;
+		virtual void trackerResetRequested(Tracker& tracker) = 0;
+		virtual void trackerTelemetryReceived(Tracker& tracker) = 0;
+		virtual bool isPortClaimed(const String& portName, const Tracker* except) = 0;
+	};
+
+	Tracker(int id, Listener& listener);
+	~Tracker();
+
+	int getId() const;
+
+	bool open(const String& portName, int baudRate);
+	void close();
+	bool isOpen() const;
+	bool isReconnecting() const;
+	void setAutoReconnect(bool shouldReconnect);
+	const String& getPortName() const;
+	bool isUsingPort(const String& portName) const;
+	void refreshPortIndex();
+
+	// lower values take precedence when several inputs drive the same tracker id
+	void setPriority(int priority) { m_priority = priority; }
+	int getPriority() const { return m_priority; }
+	int64 getLastSampleTicks() const { return m_lastSampleTicks; }
+
+	void service(uint32 now);
+	void setQuaternion(double w, double x, double y, double z);
+	void resetOrientation();
+
+	// a reset blends to the new reference over transitionSeconds, the reference is
+	// the average of the raw orientation over the last averagingSeconds
+	void setResetTransition(double transitionSeconds, double averagingSeconds);
+
+	// slowly turns the rebase against the yaw drift measured while the head is still
+	void setDriftCompensation(const DriftCompensator::Settings& settings);
+	double getDriftRate() const { return m_driftCompensator.getDriftRate(); }
+
+	// heading from the magnetometer frames, if the tracker sends them
+	CompassFusion& getCompass() { return m_compass; }
+
+	// our own firmware takes "#<tag>,<args>;" commands and answers with "#A" and "#C" frames
+	enum DeviceFeatures
+	{
+		deviceGyroCalibration = 1,
+		deviceAllSamples = 2,
+		deviceMagnetometer = 4
+	};
+
+	struct DeviceConfig
+	{
+		int rate = 0, filter = 0, features = 0, frameHold = 0;
+		bool valid = false; // the device has reported its configuration
+		char lastCommand = 0;
+		int lastResult = 0; // 0 if the device applied the last command
+		String deviceId; // unique serial number of the microcontroller
+	};
+
+	// answer to the "#S" command, the device applies and saves the biases if gyro and accel passed
+	struct SelfTestResult
+	{
+		String deviceId;
+		int mask = 0; // passed tests, bit 0 gyro, 1 accel, 2 compass
+		int gyroBias[3] = {}, accelBias[3] = {}; // raw sensor units
+		int sequence = 0; // counts the results received
+		bool passed() const { return mask == 7; }
+		String toString() const; // "mask,gx,gy,gz,ax,ay,az"
+	};
+
+	// "#T" health report, the device sends one per second, counts are since the previous one
+	struct Telemetry
+	{
+		int fifoOverflows = 0, corruptPackets = 0, i2cErrors = 0;
+		int maxLoopMicros = 0; // longest pass of the firmware loop, sleeping excluded
+		int freeRam = 0; // bytes between the heap and the stack
+		double temperature = 0.0; // degrees C of the sensor die
+		int sequence = 0; // counts the reports received since the port was opened
+		int getNumErrors() const { return fifoOverflows + corruptPackets + i2cErrors; }
+	};
+
+	// configuration commands are sent again when the device reconnects
+	bool sendCommand(char tag, const Array<int>& args = {});
+	const DeviceConfig& getDeviceConfig() const { return m_deviceConfig; }
+	const SelfTestResult& getSelfTestResult() const { return m_selfTest; }
+	const Telemetry& getTelemetry() const { return m_telemetry; }
+
+	double getQW() const { return qW; }
+	double getQX() const { return qX; }
+	double getQY() const { return qY; }
+	double getQZ() const { return qZ; }
+
+	float getRoll() const { return m_roll; }
+	float getPitch() const { return m_pitch; }
+	float getYaw() const { return m_yaw; }
+
+private:
+	bool readSerialFrames(int portIndex);
+	bool parseSerialFrame(const char* frame);
+	bool parseTaggedFrame(const char* frame);
+	static bool parseValues(const char* text, double* values, int numValues);
+	bool writeCommand(const String& command);
+	void beginReconnect(uint32 now);
+	void serviceReconnect(uint32 now);
+	void rotateRebaseYaw(double radians);
+	void getAveragedOrientation(double* q) const;
+	void updateResetTransition(int64 ticks);
+	void updateEuler();
+
+	const int m_id;
+	Listener& m_listener;
+	int m_priority = 0;
+	int64 m_lastSampleTicks = 0;
+
+	// serial port
+	String m_portName;
+	int m_portIndex = -1, m_baudRate = 115200;
+	bool m_isOpen = false;
+
+	// serial frame assembly
+	char m_serialLine[128];
+	int m_serialLineLength = 0;
+
+	// device configuration
+	StringArray m_deviceCommands;
+	DeviceConfig m_deviceConfig;
+	SelfTestResult m_selfTest;
+	Telemetry m_telemetry;
+
+	// hot-plug watchdog
+	StringArray m_portsAtLoss, m_probeCandidates;
+	bool m_autoReconnect = true, m_reconnecting = false;
+	int m_probePort = -1;
+	uint32 m_lastFrameTime = 0, m_probeDeadline = 0, m_nextReconnectAttempt = 0;
+	const uint32 m_frameTimeoutMs = 250, m_probeTimeoutMs = 500, m_reconnectIntervalMs = 100;
+
+	// the self-test blocks the firmware loop, the frame timeout waits for its answer
+	uint32 m_selfTestDeadline = 0;
+	const uint32 m_selfTestTimeoutMs = 3000;
+
+	// orientation
+	double qW = 1.0, qX = 0.0, qY = 0.0, qZ = 0.0;
+	double qlW = 1.0, qlX = 0.0, qlY = 0.0, qlZ = 0.0;
+	double qbW = 1.0, qbX = 0.0, qbY = 0.0, qbZ = 0.0;
+	float m_roll = 0.0, m_pitch = 0.0, m_yaw = 0.0;
+	DriftCompensator m_driftCompensator;
+	CompassFusion m_compass;
+
+	// recentering
+	struct RawSample
+	{
+		int64 ticks;
+		double q[4];
+	};
+	RawSample m_recentSamples[64];
+	int m_numRecentSamples = 0, m_newestRecentSample = -1;
+	double m_resetTransitionSeconds = 0.0, m_resetAveragingSeconds = 0.0;
+	double m_resetFrom[4], m_resetTo[4];
+	int64 m_resetStartTicks = 0;
+	bool m_resetting = false;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Tracker)
+};
@@ -19,8 +19,6 @@
 
 #pragma once
 
-#include <map>
-
 //==============================================================================
 /**
     This is a quick-and-dirty parser for the 3D OBJ file format.
@@ -36,13 +34,21 @@ public:
     Result load (const String& objFileContent)
     {
         shapes.clear();
-        return parseObjFile (StringArray::fromLines (objFileContent));
+        return parseObjFile (objFileContent.toRawUTF8());
     }
 
     Result load (const File& file)
     {
         sourceFile = file;
-        return load (file.loadFileAsString());
+        shapes.clear();
+
+        MemoryBlock data;
+
+        if (! file.loadFileAsData (data))
+            return Result::fail ("Cannot open file: " + file.getFileName());
+
+        data.append ("", 1); // the parser runs up to a null terminator
+        return parseObjFile (static_cast<const char*> (data.getData()));
     }
 
     //==============================================================================
@@ -97,33 +103,87 @@ private:
     {
         TripleIndex() noexcept {}
 
-        bool operator< (const TripleIndex& other) const noexcept
+        bool operator== (const TripleIndex& other) const noexcept
         {
-            if (this == &other)
-                return false;
-
-            if (vertexIndex != other.vertexIndex)
-                return vertexIndex < other.vertexIndex;
-
-            if (textureIndex != other.textureIndex)
-                return textureIndex < other.textureIndex;
+            return vertexIndex == other.vertexIndex
+                && textureIndex == other.textureIndex
+                && normalIndex == other.normalIndex;
+        }
 
-            return normalIndex < other.normalIndex;
+        uint32 hash() const noexcept
+        {
+            return ((uint32) vertexIndex * 73856093u) ^ ((uint32) textureIndex * 19349663u) ^ ((uint32) normalIndex * 83492791u);
         }
 
         int vertexIndex = -1, textureIndex = -1, normalIndex = -1;
     };
 
+    // Open addressing with linear probing, the table grows to stay at most half full
     struct IndexMap
     {
-        std::map<TripleIndex, Index> map;
+        struct Slot
+        {
+            TripleIndex key;
+            Index value;
+            bool used;
+        };
+
+        HeapBlock<Slot> slots;
+        uint32 mask = 0;
+        int numKeys = 0;
+
+        // expectedNumKeys is only the initial size, sizing it from the face triples
+        // would reserve several times the unique vertices a mesh ends up with
+        explicit IndexMap (int expectedNumKeys)
+        {
+            auto capacity = (uint32) nextPowerOfTwo (jmax (16, 2 * expectedNumKeys));
+            slots.calloc (capacity);
+            mask = capacity - 1;
+        }
+
+        void grow()
+        {
+            HeapBlock<Slot> oldSlots;
+            oldSlots.swapWith (slots);
+            auto oldCapacity = mask + 1;
+
+            slots.calloc (2 * oldCapacity);
+            mask = 2 * oldCapacity - 1;
+
+            for (uint32 i = 0; i < oldCapacity; ++i)
+            {
+                if (! oldSlots[i].used)
+                    continue;
+
+                auto slot = oldSlots[i].key.hash() & mask;
+
+                while (slots[slot].used)
+                    slot = (slot + 1) & mask;
+
+                slots[slot] = oldSlots[i];
+            }
+        }
 
         Index getIndexFor (TripleIndex i, Mesh& newMesh, const Mesh& srcMesh)
         {
-            const std::map<TripleIndex, Index>::iterator it (map.find (i));
+            auto slot = i.hash() & mask;
+
+            while (slots[slot].used)
+            {
+                if (slots[slot].key == i)
+                    return slots[slot].value;
+
+                slot = (slot + 1) & mask;
+            }
+
+            if ((uint32) (2 * (numKeys + 1)) > mask + 1)
+            {
+                grow();
+                slot = i.hash() & mask;
 
-            if (it != map.end())
-                return it->second;
+                while (slots[slot].used)
+                    slot = (slot + 1) & mask;
+            }
 
             auto index = (Index) newMesh.vertices.size();
 
@@ -136,7 +196,10 @@ private:
             if (isPositiveAndBelow (i.textureIndex, srcMesh.textureCoords.size()))
                 newMesh.textureCoords.add (srcMesh.textureCoords.getReference (i.textureIndex));
 
-            map[i] = index;
+            slots[slot].key = i;
+            slots[slot].value = index;
+            slots[slot].used = true;
+            ++numKeys;
             return index;
         }
     };
@@ -182,107 +245,198 @@ private:
         return false;
     }
 
-    struct Face
+    //==============================================================================
+    // OBJ files are parsed in a single pass over the raw text, without copying lines
+    static bool isEndOfLine (char c) noexcept    { return c == 0 || c == '\n' || c == '\r'; }
+    static bool isEndOfToken (char c) noexcept   { return isEndOfLine (c) || c == ' ' || c == '\t'; }
+
+    static const char* skipSpaces (const char* t) noexcept
     {
-        Face (String::CharPointerType t)
+        while (*t == ' ' || *t == '\t')
+            ++t;
+
+        return t;
+    }
+
+    static const char* findNextLine (const char* t) noexcept
+    {
+        while (*t != 0 && *t != '\n')
+            ++t;
+
+        return *t == '\n' ? t + 1 : t;
+    }
+
+    static String readRestOfLine (const char* t)
+    {
+        auto* end = t;
+
+        while (! isEndOfLine (*end))
+            ++end;
+
+        return String::fromUTF8 (t, (int) (end - t)).trim();
+    }
+
+    static bool matchToken (const char*& t, const char* token) noexcept
+    {
+        auto len = strlen (token);
+
+        if (strncmp (t, token, len) == 0 && isEndOfToken (t[len]))
         {
-            while (! t.isEmpty())
-                triples.add (parseTriple (t));
+            t = skipSpaces (t + len);
+            return true;
         }
 
-        Array<TripleIndex> triples;
+        return false;
+    }
 
-        void addIndices (Mesh& newMesh, const Mesh& srcMesh, IndexMap& indexMap)
-        {
-            TripleIndex i0 (triples[0]), i1, i2 (triples[1]);
+    static float parseFloat (const char*& t)
+    {
+        t = skipSpaces (t);
 
-            for (auto i = 2; i < triples.size(); ++i)
-            {
-                i1 = i2;
-                i2 = triples.getReference (i);
+        // readDoubleValue() would skip the line break and read the next line
+        if (isEndOfLine (*t))
+            return 0.0f;
 
-                newMesh.indices.add (indexMap.getIndexFor (i0, newMesh, srcMesh));
-                newMesh.indices.add (indexMap.getIndexFor (i1, newMesh, srcMesh));
-                newMesh.indices.add (indexMap.getIndexFor (i2, newMesh, srcMesh));
-            }
-        }
+        CharPointer_ASCII p (t);
+        auto value = (float) CharacterFunctions::readDoubleValue (p);
+        t = p.getAddress();
+        return value;
+    }
 
-        static TripleIndex parseTriple (String::CharPointerType& t)
-        {
-            TripleIndex i;
+    static Vertex parseVertex (const char* t)
+    {
+        Vertex v;
+        v.x = parseFloat (t);
+        v.y = parseFloat (t);
+        v.z = parseFloat (t);
+        return v;
+    }
 
-            t = t.findEndOfWhitespace();
-            i.vertexIndex = t.getIntValue32() - 1;
-            t = findEndOfFaceToken (t);
+    static TextureCoord parseTextureCoord (const char* t)
+    {
+        TextureCoord tc;
+        tc.x = parseFloat (t);
+        tc.y = parseFloat (t);
+        return tc;
+    }
+
+    // OBJ indices are one based, negative ones count back from the last element read
+    static int parseIndex (const char*& t, int numElements) noexcept
+    {
+        auto negative = (*t == '-');
 
-            if (t.isEmpty() || t.getAndAdvance() != '/')
-                return i;
+        if (negative)
+            ++t;
 
-            if (*t == '/')
-            {
-                ++t;
-            }
-            else
-            {
-                i.textureIndex = t.getIntValue32() - 1;
-                t = findEndOfFaceToken (t);
+        auto index = 0;
 
-                if (t.isEmpty() || t.getAndAdvance() != '/')
-                    return i;
-            }
+        while (*t >= '0' && *t <= '9')
+            index = index * 10 + (*t++ - '0');
 
-            i.normalIndex = t.getIntValue32() - 1;
-            t = findEndOfFaceToken (t);
-            return i;
+        return negative ? numElements - index : index - 1;
+    }
+
+    static TripleIndex parseTriple (const char*& t, const Mesh& srcMesh) noexcept
+    {
+        TripleIndex i;
+        i.vertexIndex = parseIndex (t, srcMesh.vertices.size());
+
+        if (*t == '/')
+        {
+            if (*++t != '/')
+                i.textureIndex = parseIndex (t, srcMesh.textureCoords.size());
+
+            if (*t == '/')
+                i.normalIndex = parseIndex (++t, srcMesh.normals.size());
         }
 
-        static String::CharPointerType findEndOfFaceToken (String::CharPointerType t) noexcept
+        while (! isEndOfToken (*t))
+            ++t;
+
+        t = skipSpaces (t);
+        return i;
+    }
+
+    // the faces of a group share one flat array of triples
+    struct FaceGroup
+    {
+        Array<TripleIndex> triples;
+        Array<int> faceSizes;
+
+        void clear()
         {
-            return CharacterFunctions::findEndOfToken (t, CharPointer_ASCII ("/ \t"), String().getCharPointer());
+            triples.clearQuick();
+            faceSizes.clearQuick();
         }
     };
 
     static Shape* parseFaceGroup (const Mesh& srcMesh,
-                                  Array<Face>& faceGroup,
+                                  const FaceGroup& faceGroup,
                                   const Material& material,
                                   const String& name)
     {
-        if (faceGroup.size() == 0)
+        if (faceGroup.faceSizes.size() == 0)
             return nullptr;
 
         std::unique_ptr<Shape> shape (new Shape());
         shape->name = name;
         shape->material = material;
 
-        IndexMap indexMap;
+        auto& newMesh = shape->mesh;
+        // a closed mesh has about one unique triple per position or normal
+        IndexMap indexMap (jmin (faceGroup.triples.size(), jmax (srcMesh.vertices.size(), srcMesh.normals.size())));
+        auto* triple = faceGroup.triples.begin();
 
-        for (auto& f : faceGroup)
-            f.addIndices (shape->mesh, srcMesh, indexMap);
+        for (auto faceSize : faceGroup.faceSizes)
+        {
+            for (auto i = 2; i < faceSize; ++i)
+            {
+                newMesh.indices.add (indexMap.getIndexFor (triple[0],     newMesh, srcMesh));
+                newMesh.indices.add (indexMap.getIndexFor (triple[i - 1], newMesh, srcMesh));
+                newMesh.indices.add (indexMap.getIndexFor (triple[i],     newMesh, srcMesh));
+            }
+
+            triple += faceSize;
+        }
 
         return shape.release();
     }
 
-    Result parseObjFile (const StringArray& lines)
+    Result parseObjFile (const char* text)
     {
         Mesh mesh;
-        Array<Face> faceGroup;
+        FaceGroup faceGroup;
 
         Array<Material> knownMaterials;
         Material lastMaterial;
         String lastName;
 
-        for (auto lineNum = 0; lineNum < lines.size(); ++lineNum)
+        for (auto* line = text; *line != 0; line = findNextLine (line))
         {
-            auto l = lines[lineNum].getCharPointer().findEndOfWhitespace();
+            auto* l = skipSpaces (line);
 
             if (matchToken (l, "v"))    { mesh.vertices     .add (parseVertex (l));       continue; }
             if (matchToken (l, "vn"))   { mesh.normals      .add (parseVertex (l));       continue; }
             if (matchToken (l, "vt"))   { mesh.textureCoords.add (parseTextureCoord (l)); continue; }
-            if (matchToken (l, "f"))    { faceGroup         .add (Face (l));              continue; }
+
+            if (matchToken (l, "f"))
+            {
+                auto faceSize = 0;
+
+                for (; ! isEndOfLine (*l); ++faceSize)
+                    faceGroup.triples.add (parseTriple (l, mesh));
+
+                if (faceSize >= 3)
+                    faceGroup.faceSizes.add (faceSize);
+                else
+                    faceGroup.triples.removeLast (faceSize);
+
+                continue;
+            }
 
             if (matchToken (l, "usemtl"))
             {
-                auto name = String (l).trim();
+                auto name = readRestOfLine (l);
 
                 for (auto i = knownMaterials.size(); --i >= 0;)
                 {
@@ -298,7 +452,7 @@ private:
 
             if (matchToken (l, "mtllib"))
             {
-                auto r = parseMaterial (knownMaterials, String (l).trim());
+                auto r = parseMaterial (knownMaterials, readRestOfLine (l));
                 continue;
             }
 
@@ -308,7 +462,7 @@ private:
                     shapes.add (shape);
 
                 faceGroup.clear();
-                lastName = StringArray::fromTokens (l, " \t", "")[0];
+                lastName = StringArray::fromTokens (readRestOfLine (l), " \t", "")[0];
                 continue;
             }
         }
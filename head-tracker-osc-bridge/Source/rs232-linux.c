@@ -81,13 +81,26 @@ int _BaudFlag(int BaudRate);
 /*****************************************************************************/
 int comEnumerate()
 {
+// Keep track of opened ports
+    COMDevice opened[COM_MAXDEVICES];
+    int noOpened = 0;
     for (int i = 0; i < noDevices; i++) {
-        if (comDevices[i].port) free(comDevices[i].port);
+        if (comDevices[i].handle > 0 && comDevices[i].port)
+            opened[noOpened ++] = comDevices[i];
+        else if (comDevices[i].port)
+            free(comDevices[i].port);
         comDevices[i].port = NULL;
     }
     noDevices = 0;
     for (int i = 0; i < noBases; i++)
         _AppendDevices(devBases[i]);
+// Restore handles of ports still present, close vanished ones
+    for (int i = 0; i < noOpened; i++) {
+        int p = comFindPort(opened[i].port);
+        if (p >= 0) comDevices[p].handle = opened[i].handle;
+        else close(opened[i].handle);
+        free(opened[i].port);
+    }
     return noDevices;
 }
 
@@ -145,6 +145,12 @@ int comEnumerate()
         SetLastError(0);
         QueryDosDeviceA(NULL, list, size);
     }
+// Keep track of opened ports
+    COMDevice opened[COM_MAXDEVICES];
+    int noOpened = 0;
+    for (int i = 0; i < noDevices; i++)
+        if (comDevices[i].handle)
+            opened[noOpened ++] = comDevices[i];
 // Gather all COM ports
     int port;
     const char * nlist = findPattern(list, comPtn, &port);
@@ -156,6 +162,14 @@ int comEnumerate()
         nlist = findPattern(nlist, comPtn, &port);
     }
     free(list);
+// Restore handles of ports still present, close vanished ones
+    for (int i = 0; i < noOpened; i++) {
+        int p;
+        for (p = 0; p < noDevices; p++)
+            if (comDevices[p].port == opened[i].port) break;
+        if (p < noDevices) comDevices[p].handle = opened[i].handle;
+        else CloseHandle(opened[i].handle);
+    }
     return noDevices;
 }
 
@@ -62,6 +62,8 @@ extern "C" {
     /**
      * \fn int comEnumerate()
      * \brief Enumerate available serial ports (Serial, USB serial, Bluetooth serial)
+     * \brief Ports opened before enumeration stay open if still present,
+     * \brief but their index may change (use comFindPort to locate them)
      * \return number of enumerated ports
      */
     int comEnumerate();
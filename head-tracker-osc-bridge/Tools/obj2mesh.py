@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+	nvsonic Head Tracker OSC Bridge
+	https://github.com/trsonic/nvsonic-head-tracker
+
+	Converts a Wavefront OBJ model into the packed mesh blob loaded by
+	BinauralHeadView, so the app doesn't have to parse the OBJ at startup.
+
+	usage: obj2mesh.py ../Resources/male_head.obj ../Resources/male_head.mesh
+
+	Blob layout, all values are little endian:
+		char[4]  magic "HTMH"
+		uint32   version
+		uint32   number of shapes
+		per shape:
+			uint32   number of vertices
+			uint32   number of indices
+			vertices, 16 bytes each: float position xyz, int8 normal xyz, padding
+			uint32[] triangle indices
+
+	Positions are pre-scaled to the size the view expects, normals are
+	packed as normalised signed bytes. Re-run the script and re-save the
+	project in the Projucer after changing the model.
+"""
+
+import struct
+import sys
+
+MAGIC = b"HTMH"
+VERSION = 2
+SCALE = 0.2
+DEFAULT_NORMAL = (0.5, 0.5, 0.5)
+
+
+def parse_triple(token):
+	# "v", "v/t", "v//n" or "v/t/n", one based
+	fields = token.split("/")
+	vertex = int(fields[0]) - 1
+	texture = int(fields[1]) - 1 if len(fields) > 1 and fields[1] else -1
+	normal = int(fields[2]) - 1 if len(fields) > 2 and fields[2] else -1
+	return (vertex, texture, normal)
+
+
+def build_shape(positions, normals, faces):
+	# same vertex deduplication and fan triangulation as WavefrontObjParser.h
+	index_map = {}
+	shape_positions, shape_normals, indices = [], [], []
+
+	def index_for(triple):
+		if triple not in index_map:
+			index_map[triple] = len(shape_positions)
+			vertex, _, normal = triple
+			if 0 <= vertex < len(positions):
+				shape_positions.append(positions[vertex])
+			if 0 <= normal < len(normals):
+				shape_normals.append(normals[normal])
+		return index_map[triple]
+
+	for face in faces:
+		for i in range(2, len(face)):
+			indices += [index_for(face[0]), index_for(face[i - 1]), index_for(face[i])]
+
+	vertices = bytearray()
+	for i, position in enumerate(shape_positions):
+		normal = shape_normals[i] if i < len(shape_normals) else DEFAULT_NORMAL
+		vertices += struct.pack("<3f", *[SCALE * c for c in position])
+		vertices += struct.pack("<4b", *[pack_normal(c) for c in normal], 0)
+
+	return len(shape_positions), vertices, indices
+
+
+def pack_normal(component):
+	return max(-127, min(127, int(round(component * 127.0))))
+
+
+def convert(obj_path):
+	positions, normals, faces, shapes = [], [], [], []
+
+	with open(obj_path, "r") as obj:
+		for line in obj:
+			tokens = line.split()
+			if not tokens:
+				continue
+
+			if tokens[0] == "v":
+				positions.append(tuple(float(t) for t in tokens[1:4]))
+			elif tokens[0] == "vn":
+				normals.append(tuple(float(t) for t in tokens[1:4]))
+			elif tokens[0] == "f":
+				faces.append([parse_triple(t) for t in tokens[1:]])
+			elif tokens[0] in ("o", "g"):
+				if faces:
+					shapes.append(build_shape(positions, normals, faces))
+				faces = []
+
+	if faces:
+		shapes.append(build_shape(positions, normals, faces))
+
+	blob = bytearray(MAGIC + struct.pack("<II", VERSION, len(shapes)))
+	for num_vertices, vertices, indices in shapes:
+		blob += struct.pack("<II", num_vertices, len(indices))
+		blob += vertices
+		blob += struct.pack("<%dI" % len(indices), *indices)
+
+	return bytes(blob)
+
+
+if __name__ == "__main__":
+	if len(sys.argv) != 3:
+		sys.exit("usage: obj2mesh.py input.obj output.mesh")
+
+	with open(sys.argv[2], "wb") as mesh:
+		mesh.write(convert(sys.argv[1]))